@@ -1,21 +1,18 @@
+#include "frame.h"
 #include "kinect.h"
+#include "plan.h"
 #include <opencv2/core.hpp>
 #include <opencv2/opencv.hpp>
 
-cv::Mat grabFrame(std::shared_ptr<Kinect>& sptr_kinect)
+Frame grabFrame(std::shared_ptr<Kinect>& sptr_kinect)
 {
-    sptr_kinect->capture();
-    sptr_kinect->imgCapture();
-    uint8_t* rgbData = k4a_image_get_buffer(sptr_kinect->m_img);
-    int w = k4a_image_get_width_pixels(sptr_kinect->m_img);
-    int h = k4a_image_get_height_pixels(sptr_kinect->m_img);
+    CapturePlan plan(sptr_kinect, COLOR);
+    plan.capture();
 
-    cv::Mat frame
-        = cv::Mat(h, w, CV_8UC4, (void*)rgbData, cv::Mat::AUTO_STEP).clone();
-
-    sptr_kinect->releaseK4aCapture();
-    sptr_kinect->releaseK4aImages();
+    // frame holds its own reference on the image: no copy needed
+    Frame frame(sptr_kinect->m_img, CV_8UC4);
 
+    plan.release();
     return frame;
 }
 
@@ -24,7 +21,8 @@ int main()
     // initialize kinect
     std::shared_ptr<Kinect> sptr_kinect(new Kinect);
 
-    cv::Mat img = grabFrame(sptr_kinect);
+    Frame frame = grabFrame(sptr_kinect);
+    const cv::Mat& img = frame.mat();
 
     // show images and wait for keypress
     cv::imshow("", img);
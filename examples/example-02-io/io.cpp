@@ -1,57 +1,99 @@
+#include "frame.h"
 #include "kinect.h"
+#include "pixel.h"
+#include "plan.h"
+#include <iostream>
 #include <opencv2/opencv.hpp>
 
-cv::Mat grabFrame(std::shared_ptr<Kinect>& sptr_kinect)
+Frame grabFrame(std::shared_ptr<Kinect>& sptr_kinect)
 {
-    sptr_kinect->capture();
-    sptr_kinect->imgCapture();
-    uint8_t* rgbData = k4a_image_get_buffer(sptr_kinect->m_img);
-    int w = k4a_image_get_width_pixels(sptr_kinect->m_img);
-    int h = k4a_image_get_height_pixels(sptr_kinect->m_img);
+    CapturePlan plan(sptr_kinect, COLOR);
+    plan.capture();
 
-    cv::Mat frame
-        = cv::Mat(h, w, CV_8UC4, (void*)rgbData, cv::Mat::AUTO_STEP).clone();
-
-    sptr_kinect->releaseK4aCapture();
-    sptr_kinect->releaseK4aImages();
+    // frame holds its own reference on the image: no copy needed
+    Frame frame(sptr_kinect->m_img, CV_8UC4);
 
+    plan.release();
     return frame;
 }
 
+// the per-pixel kernels below: x * 0.5 truncated is x >> 1; lambdas,
+// not functions, so pixel::apply is instantiated on (and inlines) each
+// kernel instead of calling through a function pointer per pixel
+static const auto halve = [](uint8_t* px) { px[0] = px[0] >> 1; };
+static const auto zeroBlue = [](uint8_t* px) { px[0] = 0; };
+
+#define BENCHMARK 0
+#if BENCHMARK == 1
+// mean ms of f over a few runs
+template <typename F> double elapsed(F f)
+{
+    const int runs = 20;
+    int64 t0 = cv::getTickCount();
+    for (int i = 0; i < runs; i++) {
+        f();
+    }
+    return (cv::getTickCount() - t0) * 1000.0 / cv::getTickFrequency() / runs;
+}
+
+// at<>() loops against pixel kernels on the same images
+void benchmark(const cv::Mat& grey, const cv::Mat& rgb)
+{
+    cv::Mat g = grey.clone();
+    cv::Mat c = rgb.clone();
+    double atGrey = elapsed([&]() {
+        for (int r = 0; r < g.rows; r++) {
+            for (int k = 0; k < g.cols; k++) {
+                g.at<uint8_t>(r, k)
+                    = (unsigned char)(g.at<uint8_t>(r, k) * 0.5);
+            }
+        }
+    });
+    double atRgb = elapsed([&]() {
+        for (int r = 0; r < c.rows; r++) {
+            for (int k = 0; k < c.cols; k++) {
+                c.at<cv::Vec3b>(r, k)[0] = c.at<cv::Vec3b>(r, k)[0] * 0;
+            }
+        }
+    });
+    double pixelGrey = elapsed([&]() { pixel::apply<uint8_t, 1>(g, halve); });
+    double pixelRgb = elapsed([&]() { pixel::apply<uint8_t, 3>(c, zeroBlue); });
+
+    std::cout << "-- halve: at<> " << atGrey << " ms, pixel " << pixelGrey
+              << " ms" << std::endl;
+    std::cout << "-- zero channel: at<> " << atRgb << " ms, pixel " << pixelRgb
+              << " ms" << std::endl;
+}
+#endif
+
 int main()
 {
     // initialize kinect
     std::shared_ptr<Kinect> sptr_kinect(new Kinect);
 
-    cv::Mat frame = grabFrame(sptr_kinect);
+    Frame frame = grabFrame(sptr_kinect);
 
     // write image
     const std::string IMAGE = "./scene.png";
-    cv::imwrite(IMAGE, frame);
+    cv::imwrite(IMAGE, frame.mat());
 
     // load image (read gray scale component)
     cv::Mat greyImg = cv::imread(IMAGE, cv::IMREAD_GRAYSCALE);
     cv::Mat greyImgMod = cv::imread(IMAGE, cv::IMREAD_GRAYSCALE);
 
     // modifying: reduce brightness
-    for (int r = 0; r < greyImg.rows; r++) {
-        for (int c = 0; c < greyImg.cols; c++) {
-            greyImgMod.at<uint8_t>(r, c)
-                = (unsigned char)(greyImgMod.at<uint8_t>(r, c) * 0.5);
-        }
-    }
+    pixel::apply<uint8_t, 1>(greyImgMod, halve);
 
     // load image (read RGB component)
     cv::Mat rgbImg = cv::imread(IMAGE, cv::IMREAD_COLOR);
     cv::Mat rgbImgMod = cv::imread(IMAGE, cv::IMREAD_COLOR);
 
-    // modify: remove red channel
-    for (int r = 0; r < rgbImg.rows; r++) {
-        for (int c = 0; c < rgbImg.cols; c++) {
-            rgbImgMod.at<cv::Vec3b>(r, c)[0]
-                = rgbImgMod.at<cv::Vec3b>(r, c)[0] * 0;
-        }
-    }
+    // modify: remove channel 0 (blue, images load as BGR)
+    pixel::apply<uint8_t, 3>(rgbImgMod, zeroBlue);
+
+#if BENCHMARK == 1
+    benchmark(greyImg, rgbImg);
+#endif
 
     // show images and wait for keypress
     cv::imshow("Grey", greyImg);
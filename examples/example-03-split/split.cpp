@@ -1,20 +1,17 @@
+#include "frame.h"
 #include "kinect.h"
+#include "plan.h"
 #include <opencv2/opencv.hpp>
 
-cv::Mat grabFrame(std::shared_ptr<Kinect>& sptr_kinect)
+Frame grabFrame(std::shared_ptr<Kinect>& sptr_kinect)
 {
-    sptr_kinect->capture();
-    sptr_kinect->imgCapture();
-    uint8_t* rgbData = k4a_image_get_buffer(sptr_kinect->m_img);
-    int w = k4a_image_get_width_pixels(sptr_kinect->m_img);
-    int h = k4a_image_get_height_pixels(sptr_kinect->m_img);
+    CapturePlan plan(sptr_kinect, COLOR);
+    plan.capture();
 
-    cv::Mat frame
-        = cv::Mat(h, w, CV_8UC4, (void*)rgbData, cv::Mat::AUTO_STEP).clone();
-
-    sptr_kinect->releaseK4aCapture();
-    sptr_kinect->releaseK4aImages();
+    // frame holds its own reference on the image: no copy needed
+    Frame frame(sptr_kinect->m_img, CV_8UC4);
 
+    plan.release();
     return frame;
 }
 
@@ -23,12 +20,12 @@ int main()
     // initialize kinect
     std::shared_ptr<Kinect> sptr_kinect(new Kinect);
 
-    // clone and convert to OpenCV Mat
-    cv::Mat frame = grabFrame(sptr_kinect);
+    // view as OpenCV Mat
+    Frame frame = grabFrame(sptr_kinect);
 
     // write image
     const std::string IMAGE = "./scene.png";
-    cv::imwrite(IMAGE, frame);
+    cv::imwrite(IMAGE, frame.mat());
 
     // The image from the kinect needs to be cast into a cv color image,
     // i.e., into a 3 channel image first before using split.
@@ -41,7 +38,7 @@ int main()
     cv::split(rgbImg, rgbChannel);
 
     // show split channels
-    cv::imshow("rgb", frame);
+    cv::imshow("rgb", frame.mat());
     cv::imshow("blue", rgbChannel[0]);
     cv::imshow("green", rgbChannel[1]);
     cv::imshow("red", rgbChannel[2]);
@@ -1,43 +1,9 @@
+#include "frame.h"
 #include "kinect.h"
+#include "plan.h"
+#include "spectrum.h"
 #include <opencv2/opencv.hpp>
 
-void computeDft(cv::Mat& source, cv::Mat& destination)
-{
-    cv::Mat grayImageComplex[2]
-        = { source, cv::Mat::zeros(source.size(), CV_32F) };
-
-    cv::Mat dft;
-    cv::Mat grayImageDft;
-
-    cv::merge(grayImageComplex, 2, dft);
-    cv::dft(dft, grayImageDft, cv::DFT_COMPLEX_OUTPUT);
-
-    destination = grayImageDft;
-}
-
-// only applied for visualization purposes
-//
-void recenterDft(cv::Mat& source)
-{
-    int centerX = source.cols / 2;
-    int centerY = source.rows / 2;
-
-    cv::Mat q1(source, cv::Rect(0, 0, centerX, centerY));
-    cv::Mat q2(source, cv::Rect(centerX, 0, centerX, centerY));
-    cv::Mat q3(source, cv::Rect(0, centerY, centerX, centerY));
-    cv::Mat q4(source, cv::Rect(centerX, centerY, centerX, centerY));
-
-    cv::Mat swapMap;
-
-    q1.copyTo(swapMap);
-    q4.copyTo(q1);
-    swapMap.copyTo(q4);
-
-    q2.copyTo(swapMap);
-    q3.copyTo(q2);
-    swapMap.copyTo(q3);
-}
-
 void showDft(cv::Mat& source)
 {
     cv::Mat splitChannel[2] = { cv::Mat::zeros(source.size(), CV_32F),
@@ -57,7 +23,7 @@ void showDft(cv::Mat& source)
 // only be used for visualization
 //
 #if VISUALIZE == 1
-    recenterDft(dftMagnitude);
+    Spectrum::recenter(dftMagnitude);
 #endif
 
     // output
@@ -65,29 +31,15 @@ void showDft(cv::Mat& source)
     cv::waitKey();
 }
 
-// inverting back from the frequency domain
-void invertDft(cv::Mat& source, cv::Mat& destination)
-{
-    cv::Mat inverse;
-    cv::dft(source, inverse,
-        cv::DFT_INVERSE | cv::DFT_REAL_OUTPUT | CV_HAL_DFT_SCALE);
-    destination = inverse;
-}
-
-cv::Mat grabFrame(std::shared_ptr<Kinect>& sptr_kinect)
+Frame grabFrame(std::shared_ptr<Kinect>& sptr_kinect)
 {
-    sptr_kinect->capture();
-    sptr_kinect->imgCapture();
-    uint8_t* rgbData = k4a_image_get_buffer(sptr_kinect->m_img);
-    int w = k4a_image_get_width_pixels(sptr_kinect->m_img);
-    int h = k4a_image_get_height_pixels(sptr_kinect->m_img);
-
-    cv::Mat frame
-        = cv::Mat(h, w, CV_8UC4, (void*)rgbData, cv::Mat::AUTO_STEP).clone();
+    CapturePlan plan(sptr_kinect, COLOR);
+    plan.capture();
 
-    sptr_kinect->releaseK4aCapture();
-    sptr_kinect->releaseK4aImages();
+    // frame holds its own reference on the image: no copy needed
+    Frame frame(sptr_kinect->m_img, CV_8UC4);
 
+    plan.release();
     return frame;
 }
 
@@ -96,11 +48,11 @@ int main()
     // initialize kinect
     std::shared_ptr<Kinect> sptr_kinect(new Kinect);
 
-    cv::Mat img = grabFrame(sptr_kinect);
+    Frame frame = grabFrame(sptr_kinect);
 
     // write image
     const std::string IMAGE = "./scene.png";
-    cv::imwrite(IMAGE, img);
+    cv::imwrite(IMAGE, frame.mat());
 
     // load grey-scale image
     cv::Mat greyImg = cv::imread(IMAGE, cv::IMREAD_GRAYSCALE);
@@ -109,12 +61,29 @@ int main()
     cv::Mat grayImageFloat;
     greyImg.convertTo(grayImageFloat, CV_32FC1, 1.0 / 255.0);
 
-    cv::Mat imgDft;
-    computeDft(grayImageFloat, imgDft);
+    // real-input transform on an optimally padded buffer; the complex
+    // output layout is only needed to display the magnitude
+    Spectrum spectrum;
+    cv::Mat imgDft = spectrum.forward(grayImageFloat, cv::DFT_COMPLEX_OUTPUT);
     showDft(imgDft);
 
     cv::Mat invertedDft;
-    invertDft(imgDft, invertedDft);
+    spectrum.inverse(imgDft, invertedDft);
     cv::imshow("inverted dft", invertedDft);
     cv::waitKey();
+
+#define FILTER 0
+#if FILTER == 1
+    // low-pass live frames in the frequency domain
+    SpectralFilter filter(cv::getGaussianKernel(31, 5, CV_32F)
+        * cv::getGaussianKernel(31, 5, CV_32F).t());
+    cv::Mat gray, grayFloat, filtered;
+    while (cv::waitKey(1) != 27) {
+        Frame live = grabFrame(sptr_kinect);
+        cv::cvtColor(live.mat(), gray, cv::COLOR_BGRA2GRAY);
+        gray.convertTo(grayFloat, CV_32FC1, 1.0 / 255.0);
+        filter.apply(grayFloat, filtered);
+        cv::imshow("filtered", filtered);
+    }
+#endif
 }
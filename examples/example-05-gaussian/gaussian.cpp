@@ -1,36 +1,20 @@
+#include "convolve.h"
+#include "frame.h"
+#include "kernel.h"
 #include "kinect.h"
+#include "plan.h"
+#include <iostream>
 #include <opencv2/opencv.hpp>
 
-void createGaussian(cv::Size& size, cv::Mat& output, int uX, int uY,
-    float sigmaX, float sigmaY, float amplitude = 1.0f)
+Frame grabFrame(std::shared_ptr<Kinect>& sptr_kinect)
 {
-    cv::Mat temp = cv::Mat(size, CV_32F);
-    for (int r = 0; r < size.height; r++) {
-        for (int c = 0; c < size.width; c++) {
-            float x = (float)((c - uX) * (c - uX)) / (2.0f * sigmaX * sigmaX);
-            float y = (float)((c - uY) * (c - uY)) / (2.0f * sigmaY * sigmaY);
-            float value = amplitude * exp(-(x + y));
-            temp.at<float>(r, c) = value;
-        }
-        cv::normalize(temp, temp, 0.0f, 1.0f, cv::NORM_MINMAX);
-        output = temp;
-    }
-}
-
-cv::Mat grabFrame(std::shared_ptr<Kinect>& sptr_kinect)
-{
-    sptr_kinect->capture();
-    sptr_kinect->imgCapture();
-    uint8_t* rgbData = k4a_image_get_buffer(sptr_kinect->m_img);
-    int w = k4a_image_get_width_pixels(sptr_kinect->m_img);
-    int h = k4a_image_get_height_pixels(sptr_kinect->m_img);
+    CapturePlan plan(sptr_kinect, COLOR);
+    plan.capture();
 
-    cv::Mat frame
-        = cv::Mat(h, w, CV_8UC4, (void*)rgbData, cv::Mat::AUTO_STEP).clone();
-
-    sptr_kinect->releaseK4aCapture();
-    sptr_kinect->releaseK4aImages();
+    // frame holds its own reference on the image: no copy needed
+    Frame frame(sptr_kinect->m_img, CV_8UC4);
 
+    plan.release();
     return frame;
 }
 
@@ -39,19 +23,31 @@ int main()
     // initialize kinect
     std::shared_ptr<Kinect> sptr_kinect(new Kinect);
 
-    cv::Mat frame = grabFrame(sptr_kinect);
+    Frame frame = grabFrame(sptr_kinect);
 
     // write image
     const std::string IMAGE = "./scene.png";
-    cv::imwrite(IMAGE, frame);
+    cv::imwrite(IMAGE, frame.mat());
 
     // load image in grey scale
     cv::Mat grayImage = cv::imread(IMAGE, cv::IMREAD_GRAYSCALE);
 
-    //  do gaussian computation
-    cv::Mat output;
+    //  do gaussian computation: outer product of two 1D gaussians,
+    //  peaking at 1 in the center
     cv::Size s = cv::Size(256, 256);
-    createGaussian(s, output, 256 / 2, 256 / 2, 10, 10, 1.0f);
+    int64 t0 = cv::getTickCount();
+    cv::Mat output = kernel::gaussian(
+        s, cv::Point2f(256 / 2, 256 / 2), cv::Point2f(10, 10));
+    std::cout << "-- " << s << " gaussian in "
+              << (cv::getTickCount() - t0) * 1e6 / cv::getTickFrequency()
+              << " us" << std::endl;
     cv::imshow("gaussian", output);
+
+    // the separable factors blur without building the 2D kernel
+    cv::Mat kx, ky, blurred;
+    kernel::gaussianFactors(cv::Size(31, 31), cv::Point2f(15, 15),
+        cv::Point2f(5, 5), kx, ky, kernel::UNIT_SUM);
+    Convolver(kx, ky).apply(grayImage, blurred);
+    cv::imshow("blurred", blurred);
     cv::waitKey();
 }
@@ -1,39 +1,78 @@
-#include <chrono>
+#include <atomic>
+#include <iostream>
 #include <opencv2/opencv.hpp>
+#include <string>
 #include <thread>
 
+#include "frame.h"
 #include "kinect.h"
+#include "pipeline.h"
+#include "plan.h"
 
-cv::Mat grabFrame(std::shared_ptr<Kinect>& sptr_kinect)
+Frame grabFrame(std::shared_ptr<Kinect>& sptr_kinect)
 {
-    sptr_kinect->capture();
-    sptr_kinect->imgCapture();
-    uint8_t* rgbData = k4a_image_get_buffer(sptr_kinect->m_img);
-    int w = k4a_image_get_width_pixels(sptr_kinect->m_img);
-    int h = k4a_image_get_height_pixels(sptr_kinect->m_img);
+    CapturePlan plan(sptr_kinect, COLOR);
+    plan.capture();
 
-    cv::Mat frame
-        = cv::Mat(h, w, CV_8UC4, (void*)rgbData, cv::Mat::AUTO_STEP).clone();
-
-    sptr_kinect->releaseK4aCapture();
-    sptr_kinect->releaseK4aImages();
+    // frame holds its own reference on the image: no copy needed
+    Frame frame(sptr_kinect->m_img, CV_8UC4);
 
+    plan.release();
     return frame;
 }
 
+void showStats(cv::Mat& img, const PipelineStats& stats)
+{
+    std::string text = "queue: " + std::to_string(stats.m_depth)
+        + "  captured: " + std::to_string(stats.m_captured)
+        + "  dropped: " + std::to_string(stats.m_dropped);
+    cv::putText(img, text, cv::Point(20, 40), cv::FONT_HERSHEY_SIMPLEX, 1.0,
+        cv::Scalar(0, 255, 0), 2);
+}
+
 int main()
 {
     // initialize kinect
     std::shared_ptr<Kinect> sptr_kinect(new Kinect);
 
-    while (true) {
-        cv::Mat frame = grabFrame(sptr_kinect);
+    // capture thread: the display only ever needs the newest frame
+    Pipeline<Frame> capture(
+        [&]() { return grabFrame(sptr_kinect); }, 1, LATEST_ONLY);
 
-        cv::imshow("kinect", frame);
-        if (cv::waitKey(1000 / 20) >= 0) {
+    // processing thread: convert frames for display
+    Ring<cv::Mat> processed(2, DROP_OLDEST);
+    std::atomic<bool> running(true);
+    std::thread processing([&]() {
+        Frame frame;
+        while (running) {
+            if (!capture.pop(frame, 100)) {
+                continue;
+            }
+            cv::Mat img;
+            cv::cvtColor(frame.mat(), img, cv::COLOR_BGRA2BGR);
+            showStats(img, capture.stats());
+            processed.push(img);
+        }
+    });
+    capture.start();
+
+    // display on the main thread (HighGUI windows are not thread safe)
+    cv::Mat img;
+    while (true) {
+        if (processed.pop(img, 100)) {
+            cv::imshow("kinect", img);
+        }
+        if (cv::waitKey(1) >= 0) {
             break;
         }
-        std::this_thread::sleep_for(std::chrono::microseconds(2));
     }
+
+    running = false;
+    capture.stop();
+    processing.join();
+
+    PipelineStats stats = capture.stats();
+    std::cout << "-- captured " << stats.m_captured << " frames, dropped "
+              << stats.m_dropped << std::endl;
     return 0;
 }
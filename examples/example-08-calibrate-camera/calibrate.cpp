@@ -1,19 +1,32 @@
+#include <iostream>
 #include <opencv2/opencv.hpp>
 
-#include "camera.h"
+#include "chessboard.h"
+#include "detector.h"
 #include "file.h"
+#include "frame.h"
 #include "kinect.h"
+#include "plan.h"
+#include "session.h"
 #include "usage.h"
 
-bool calibrateCamera(
-    Camera& camera, const cv::Size& dChessboard, const std::string& file)
+bool calibrateCamera(CalibrationSession& session, const std::string& file)
 {
     bool done = false;
-    if (camera.m_images.size() > 15) {
+    if (session.ready()) {
+        // the solve runs as views come in: at most the last one is pending
         usage::prompt(CALIBRATING);
-        camera.calibrate(dChessboard, chessboard::R_BLOCK_WIDTH);
+        CalibrationResult result = session.result();
+        if (result.m_views == 0) {
+            // every solve so far failed: keep capturing
+            std::cout << "-- " << session.error() << std::endl;
+            usage::prompt(MORE_IMAGES_REQUIRED);
+            return false;
+        }
+        std::cout << "-- " << result.m_views << " views, rms: " << result.m_rms
+                  << std::endl;
         usage::prompt(SAVING_PARAMETERS);
-        parameters::write(file, camera.m_K, camera.m_distortionCoefficients);
+        parameters::write(file, result.m_K, result.m_distortionCoefficients);
         done = true;
     } else {
         usage::prompt(MORE_IMAGES_REQUIRED);
@@ -21,33 +34,22 @@ bool calibrateCamera(
     return done;
 }
 
-cv::Mat grabFrame(std::shared_ptr<Kinect>& sptr_kinect)
+Frame grabFrame(std::shared_ptr<Kinect>& sptr_kinect)
 {
-    sptr_kinect->capture();
-    sptr_kinect->depthCapture();
-    sptr_kinect->pclCapture();
-    sptr_kinect->imgCapture();
-    sptr_kinect->c2dCapture();
-    sptr_kinect->transform(RGB_TO_DEPTH);
-
-    auto* rgbData = k4a_image_get_buffer(sptr_kinect->m_c2d);
-    int w = k4a_image_get_width_pixels(sptr_kinect->m_c2d);
-    int h = k4a_image_get_height_pixels(sptr_kinect->m_c2d);
-
-    cv::Mat frame
-        = cv::Mat(h, w, CV_8UC4, (void*)rgbData, cv::Mat::AUTO_STEP).clone();
+    CapturePlan plan(sptr_kinect, COLOR_TO_DEPTH);
+    plan.capture();
 
-    sptr_kinect->releaseK4aCapture();
-    sptr_kinect->releaseK4aImages();
+    // frame holds its own reference on the image: no copy needed
+    Frame frame(plan.c2d(), CV_8UC4);
 
+    plan.release();
     return frame;
 }
 
 int main()
 {
-    // initialize camera, image frames, and  window
-    Camera camera;
-    cv::Mat src, dst;
+    // initialize preview image, and  window
+    cv::Mat dst;
     std::shared_ptr<Kinect> sptr_kinect(new Kinect);
 
     std::string window = "calibration window";
@@ -59,17 +61,37 @@ int main()
     usage::prompt(USAGE);
     std::string file = "./output/calibration/camera.txt";
 
+    // search for the chessboard off the ui thread, and keep only the
+    // corners of each captured view
+    ChessboardDetector detector(dChessboard);
+    CalibrationSession session(dChessboard, chessboard::R_BLOCK_WIDTH, 16);
+    uint64_t captured = 0; // last detection added to the session
+
     while (!done) {
-        src = grabFrame(sptr_kinect);
-        bool pass = chessboard::overlay(src, dst, dChessboard, window);
+        Frame frame = grabFrame(sptr_kinect);
+        const cv::Mat& src = frame.mat(); // valid while frame lives
+        detector.submit(src);
+
+        // preview the newest finished detection
+        Detection detection = detector.latest();
+        src.copyTo(dst);
+        if (!detection.m_corners.empty()) {
+            cv::drawChessboardCorners(
+                dst, dChessboard, detection.m_corners, detection.m_found);
+        }
+        cv::imshow(window, dst);
 
         int key = cv::waitKey(30);
         switch (key) {
-        case ENTER_KEY: // capture images
-            chessboard::capture(pass, src, camera.m_images);
+        case ENTER_KEY: // capture the view the detection belongs to
+            if (detection.m_sequence != captured && session.add(detection)) {
+                captured = detection.m_sequence;
+                std::cout << "-- captured view " << session.views()
+                          << std::endl;
+            }
             break;
         case ESCAPE_KEY: // start calibration
-            done = calibrateCamera(camera, dChessboard, file);
+            done = calibrateCamera(session, file);
         default:
             break;
         }
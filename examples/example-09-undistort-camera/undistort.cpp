@@ -1,28 +1,21 @@
 #include <opencv2/opencv.hpp>
 
 #include "file.h"
+#include "frame.h"
 #include "kinect.h"
+#include "plan.h"
+#include "undistort.h"
 #include "usage.h"
 
-cv::Mat grabFrame(std::shared_ptr<Kinect>& sptr_kinect)
+Frame grabFrame(std::shared_ptr<Kinect>& sptr_kinect)
 {
-    sptr_kinect->capture();
-    sptr_kinect->depthCapture();
-    sptr_kinect->pclCapture();
-    sptr_kinect->imgCapture();
-    sptr_kinect->c2dCapture();
-    sptr_kinect->transform(RGB_TO_DEPTH);
+    CapturePlan plan(sptr_kinect, COLOR_TO_DEPTH);
+    plan.capture();
 
-    auto* rgbData = k4a_image_get_buffer(sptr_kinect->m_c2d);
-    int w = k4a_image_get_width_pixels(sptr_kinect->m_c2d);
-    int h = k4a_image_get_height_pixels(sptr_kinect->m_c2d);
-
-    cv::Mat frame
-        = cv::Mat(h, w, CV_8UC4, (void*)rgbData, cv::Mat::AUTO_STEP).clone();
-
-    sptr_kinect->releaseK4aCapture();
-    sptr_kinect->releaseK4aImages();
+    // frame holds its own reference on the image: no copy needed
+    Frame frame(plan.c2d(), CV_8UC4);
 
+    plan.release();
     return frame;
 }
 
@@ -38,24 +31,27 @@ int main()
     cv::namedWindow(OUTPUT, cv::WINDOW_AUTOSIZE);
 
     // initialize image and camera matrix
-    cv::Mat src, dst, K, refinedK, distortionCoefficients;
+    cv::Mat dst, K, distortionCoefficients;
     K = cv::Mat::eye(3, 3, CV_64F);
     usage::prompt(LOADING_CALIBRATION_PARAMETERS);
 
     std::string file = "./output/calibration/camera.txt";
     parameters::read(file, K, distortionCoefficients);
 
-    src = grabFrame(sptr_kinect);
-    cv::Size dSize = cv::Size(src.rows, src.cols);
+    Frame frame = grabFrame(sptr_kinect);
+    const cv::Mat& src = frame.mat(); // valid while frame lives
 
     /* UN-DISTORT:
      *   - alpha=0 returns undistorted image with min-unwanted pixels
      *   - alpha=1 returns undistorted image retaining black-image patches?
+     *
+     *   remap tables are built (or loaded from the calibration directory)
+     *   once; each frame after that is a single remap
      */
     int alpha = 1;
-    refinedK = cv::getOptimalNewCameraMatrix(
-        K, distortionCoefficients, dSize, alpha, dSize);
-    cv::undistort(src, dst, K, distortionCoefficients, refinedK);
+    Undistorter undistorter(
+        file, K, distortionCoefficients, src.size(), alpha);
+    undistorter.apply(src, dst);
 
     // show
     cv::imshow(INPUT, src);
@@ -1,25 +1,24 @@
+#include <iostream>
 #include <opencv2/aruco.hpp>
 #include <opencv2/core.hpp>
 #include <opencv2/opencv.hpp>
 
 #include "file.h"
+#include "frame.h"
 #include "kinect.h"
+#include "marker.h"
+#include "plan.h"
 #include "usage.h"
 
-cv::Mat grabFrame(std::shared_ptr<Kinect>& sptr_kinect)
+Frame grabFrame(std::shared_ptr<Kinect>& sptr_kinect)
 {
-    sptr_kinect->capture();
-    sptr_kinect->imgCapture();
-    uint8_t* rgbData = k4a_image_get_buffer(sptr_kinect->m_img);
-    int w = k4a_image_get_width_pixels(sptr_kinect->m_img);
-    int h = k4a_image_get_height_pixels(sptr_kinect->m_img);
+    CapturePlan plan(sptr_kinect, COLOR);
+    plan.capture();
 
-    cv::Mat frame
-        = cv::Mat(h, w, CV_8UC4, (void*)rgbData, cv::Mat::AUTO_STEP).clone();
-
-    sptr_kinect->releaseK4aCapture();
-    sptr_kinect->releaseK4aImages();
+    // frame holds its own reference on the image: no copy needed
+    Frame frame(sptr_kinect->m_img, CV_8UC4);
 
+    plan.release();
     return frame;
 }
 
@@ -43,23 +42,25 @@ int main()
 
     usage::prompt(FINDING_ARUCO_MARKERS);
     std::vector<int> markerIds;
-    std::vector<std::vector<cv::Point2f>> markerCorners, rejectedCorners;
+    std::vector<std::vector<cv::Point2f>> markerCorners;
     cv::Ptr<cv::aruco::Dictionary> markerDictionary
         = cv::aruco::getPredefinedDictionary(
             cv::aruco::PREDEFINED_DICTIONARY_NAME::DICT_4X4_50);
 
+    // search near last-known markers, the whole frame only now and then
+    MarkerTracker tracker(markerDictionary);
+
     const float ARUCO_BLOCK_WIDTH = 0.0565f;
     std::vector<cv::Vec3d> R, t;
 
     while (true) {
-        src = grabFrame(sptr_kinect);
-        cv::cvtColor(src, src, cv::COLOR_BGRA2RGB);
-        cv::aruco::detectMarkers(
-            src, markerDictionary, markerCorners, markerIds);
+        Frame frame = grabFrame(sptr_kinect);
+        tracker.detect(frame.mat(), markerCorners, markerIds);
         cv::aruco::estimatePoseSingleMarkers(
             markerCorners, ARUCO_BLOCK_WIDTH, K, distortionCoefficients, R, t);
 
         // draw axis on detected marker
+        cv::cvtColor(frame.mat(), src, cv::COLOR_BGRA2BGR);
         for (int i = 0; i < markerIds.size(); i++) {
             cv::aruco::drawAxis(
                 src, K, distortionCoefficients, R[i], t[i], 0.1f);
@@ -72,4 +73,12 @@ int main()
         if (key == 27)
             break;
     }
+
+    MarkerStats stats = tracker.stats();
+    std::cout << "-- " << stats.m_frames << " frames, "
+              << stats.m_fullSearches << " full searches, " << stats.m_meanMs
+              << " ms mean detection latency" << std::endl;
+    std::cout << "-- re-acquired " << stats.m_reacquisitions << " of "
+              << stats.m_losses << " lost markers ("
+              << 100.0 * stats.reacquisitionRate() << "%)" << std::endl;
 }
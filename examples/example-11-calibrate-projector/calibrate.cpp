@@ -7,28 +7,66 @@
 #ifndef PROJECTOR_H
 #define PROJECTOR_H
 
+#include <fstream>
+#include <iostream>
 #include <opencv2/opencv.hpp>
 
 #include "chessboard.h"
+#include "detector.h"
 #include "file.h"
+#include "frame.h"
 #include "kinect.h"
 #include "pcloud.h"
-#include "point.h"
-#include "projector.h"
+#include "plan.h"
+#include "record.h"
 #include "usage.h"
+#include "views.h"
 
-using t_pCloudFrame = std::pair<cv::Mat, std::vector<Point>>;
+// color-to-depth image and the organized point cloud it is registered
+// with, both zero-copy views of the k4a buffers
+using t_pCloudFrame = std::pair<Frame, Frame>;
 
-bool calibrationProjector(
-    Projector& projector, const cv::Size& dChessboard, const std::string& file)
+// projector resolution
+static const cv::Size PROJECTOR_SIZE(1366, 768);
+
+bool calibrationProjector(ProjectorViews& views, const cv::Size& dChessboard,
+    const std::string& file)
 {
     bool done = false;
-    if (projector.m_RGBDCollection.size() > 15) {
+    if (views.size() > 15) {
         usage::prompt(CALIBRATING);
-        projector.calibrate(dChessboard, chessboard::R_BLOCK_WIDTH);
+        std::vector<cv::Point2f> corners = ProjectorViews::projectorCorners(
+            "./resources/chessboard.png", dChessboard, PROJECTOR_SIZE);
+        if (corners.empty()) {
+            std::cerr << "-- no chessboard in ./resources/chessboard.png"
+                      << std::endl;
+            return false;
+        }
+        cv::Mat K, distortionCoefficients;
+        views.calibrate(corners, PROJECTOR_SIZE, K, distortionCoefficients);
+        double rms
+            = views.reprojectionError(corners, K, distortionCoefficients);
+        std::cout << "-- " << views.size() << " views, rms: " << rms
+                  << std::endl;
+
+        // never replace earlier parameters (e.g., from Projector::calibrate)
+        // with ones that re-project the same views worse
+        cv::Mat previousK, previousDistortion;
+        if (std::ifstream(file).good()) {
+            parameters::read(file, previousK, previousDistortion);
+        }
+        if (!previousK.empty()) {
+            double previous = views.reprojectionError(
+                corners, previousK, previousDistortion);
+            std::cout << "-- previous parameters, rms: " << previous
+                      << std::endl;
+            if (previous <= rms) {
+                std::cout << "-- keeping the previous parameters" << std::endl;
+                return true;
+            }
+        }
         usage::prompt(SAVING_PARAMETERS);
-        parameters::write(
-            file, projector.m_K, projector.m_distortionCoefficients);
+        parameters::write(file, K, distortionCoefficients);
         done = true;
     } else {
         usage::prompt(MORE_IMAGES_REQUIRED);
@@ -38,48 +76,42 @@ bool calibrationProjector(
 
 t_pCloudFrame pCloudFrame(std::shared_ptr<Kinect>& sptr_kinect)
 {
-    sptr_kinect->capture();
-    sptr_kinect->depthCapture();
-    sptr_kinect->pclCapture();
-    sptr_kinect->imgCapture();
-    sptr_kinect->c2dCapture();
-    sptr_kinect->transform(RGB_TO_DEPTH);
+    CapturePlan plan(sptr_kinect, DEPTH | POINT_CLOUD | COLOR_TO_DEPTH);
+    plan.capture();
 
+#define RECORD 0
+#if RECORD == 1
     // get depth image dimensions
     int w = k4a_image_get_width_pixels(sptr_kinect->m_depth);
     int h = k4a_image_get_height_pixels(sptr_kinect->m_depth);
 
-    // get synchronous RGB-D captures
-    auto* pCloudData
-        = (int16_t*)(void*)k4a_image_get_buffer(sptr_kinect->m_pcl);
-    auto* rgbData = k4a_image_get_buffer(sptr_kinect->m_c2d);
+    // append raw RGB-D frames to an indexed session recording
+    static Recorder recorder("./output/pcloud/session.rgbd");
+    recorder.append(k4a_image_get_device_timestamp_usec(sptr_kinect->m_depth),
+        w, h, (int16_t*)(void*)k4a_image_get_buffer(plan.pcl()),
+        k4a_image_get_buffer(plan.c2d()));
+#endif
 
-    const std::string file = "./output/pcloud/3dPCloud.ply";
-    std::vector<Point> pCloud = pcloud::build(w, h, pCloudData, rgbData);
-    // pcloud::write(rgbdPCloud, file);
-    cv::Mat frame
-        = cv::Mat(h, w, CV_8UC4, (void*)rgbData, cv::Mat::AUTO_STEP).clone();
+    // couple frame and point cloud: only the corners' xyz are looked up
+    // later, so the cloud is neither compacted nor copied
+    t_pCloudFrame data = std::make_pair(Frame(plan.c2d(), CV_8UC4),
+        Frame(plan.pcl(), CV_16SC3));
 
-    sptr_kinect->releaseK4aCapture();
-    sptr_kinect->releaseK4aImages();
-
-    t_pCloudFrame data = std::make_pair(frame, pCloud);
-
-    // couple frame and point cloud
+    plan.release();
     return data;
 }
 
 int main()
 {
-    // initialize image frames and  kinect
-    cv::Mat src, dst;
+    // initialize preview image and  kinect
+    cv::Mat dst;
     std::shared_ptr<Kinect> sptr_kinect(new Kinect);
 
-    // create projector
-    Projector projector;
+    // corner xyz of each accepted view
+    cv::Size dChessboard = cv::Size(9, 6);
+    ProjectorViews views(dChessboard);
 
     // project chessboard
-    cv::Size dChessboard = cv::Size(9, 6);
     chessboard::project(dChessboard);
 
     // setup calibration window
@@ -91,19 +123,41 @@ int main()
     usage::prompt(USAGE);
     std::string file = "./output/calibration/projector.txt";
 
+    // search for the chessboard off the ui thread
+    ChessboardDetector detector(dChessboard);
+    const double scale = 0.5;
+
+
     while (!done) {
         t_pCloudFrame rgbdData = pCloudFrame(sptr_kinect);
 
-        src = rgbdData.first; // grab image from RGBD
-        bool pass = chessboard::overlay(src, dst, dChessboard, window);
+        const cv::Mat& src = rgbdData.first.mat(); // grab image from RGBD
+        detector.submit(src);
+
+        // preview the newest finished detection
+        Detection detection = detector.latest();
+        src.copyTo(dst);
+        if (!detection.m_corners.empty()) {
+            cv::drawChessboardCorners(
+                dst, dChessboard, detection.m_corners, detection.m_found);
+        }
+        cv::imshow(window, dst);
 
         int key = cv::waitKey(30);
         switch (key) {
-        case ENTER_KEY: // capture synchronous RGBD
-            chessboard::capture(pass, rgbdData, projector.m_RGBDCollection);
+        case ENTER_KEY: { // capture synchronous RGBD
+            // the point cloud belongs to this frame: verify the board on it
+            Detection capture
+                = ChessboardDetector::detect(src, dChessboard, scale);
+            if (capture.m_found
+                && views.add(
+                    capture.m_corners, src, rgbdData.second.mat())) {
+                std::cout << "-- captured view " << views.size() << std::endl;
+            }
             break;
+        }
         case ESCAPE_KEY: // start calibration
-            done = calibrationProjector(projector, dChessboard, file);
+            done = calibrationProjector(views, dChessboard, file);
         default:
             break;
         }
@@ -1,28 +1,59 @@
 #include "scene.h"
+#include <iostream>
 #include <opencv2/opencv.hpp>
 
 #if __linux__
+#include "background.h"
+#include "frame.h"
 #include "kinect.h"
-cv::Mat grabFrame(std::shared_ptr<Kinect>& sptr_kinect)
+#include "plan.h"
+Frame grabFrame(std::shared_ptr<Kinect>& sptr_kinect)
 {
-    sptr_kinect->capture();
-    sptr_kinect->depthCapture();
-    sptr_kinect->pclCapture();
-    sptr_kinect->imgCapture();
-    sptr_kinect->c2dCapture();
-    sptr_kinect->transform(RGB_TO_DEPTH);
+    CapturePlan plan(sptr_kinect, COLOR_TO_DEPTH);
+    plan.capture();
 
-    auto* rgbData = k4a_image_get_buffer(sptr_kinect->m_c2d);
-    int w = k4a_image_get_width_pixels(sptr_kinect->m_c2d);
-    int h = k4a_image_get_height_pixels(sptr_kinect->m_c2d);
+    // frame holds its own reference on the image: no copy needed
+    Frame frame(plan.c2d(), CV_8UC4);
 
-    cv::Mat frame
-        = cv::Mat(h, w, CV_8UC4, (void*)rgbData, cv::Mat::AUTO_STEP).clone();
+    plan.release();
+    return frame;
+}
 
-    sptr_kinect->releaseK4aCapture();
-    sptr_kinect->releaseK4aImages();
+// color-to-depth and depth images of the same capture
+std::pair<Frame, Frame> grabRGBD(std::shared_ptr<Kinect>& sptr_kinect)
+{
+    CapturePlan plan(sptr_kinect, COLOR_TO_DEPTH);
+    plan.capture();
+    std::pair<Frame, Frame> frames(Frame(plan.c2d(), CV_8UC4),
+        Frame(sptr_kinect->m_depth, CV_16UC1));
+    plan.release();
+    return frames;
+}
 
-    return frame;
+// continuous subtraction against running color and depth models: no
+// projector flicker needed, a mask per frame at sensor rate
+void stream(std::shared_ptr<Kinect>& sptr_kinect)
+{
+    BackgroundModel color(30);
+    BackgroundModel depth(50); // mm
+    cv::Mat colorMask, depthMask;
+
+    while (cv::waitKey(1) != 27) {
+        std::pair<Frame, Frame> frames = grabRGBD(sptr_kinect);
+        color.apply(frames.first.mat(), colorMask);
+        depth.apply(frames.second.mat(), depthMask);
+        cv::imshow("Color foreground", colorMask);
+        cv::imshow("Depth foreground", depthMask);
+    }
+
+    for (const auto& model : { &color, &depth }) {
+        BackgroundStats stats = model->stats();
+        std::cout << "-- " << (model == &color ? "color" : "depth") << ": "
+                  << stats.m_frames << " frames, " << stats.m_meanMs
+                  << " ms mean, " << stats.m_lastMs << " ms last, "
+                  << 100.0 * stats.m_foreground << "% foreground"
+                  << std::endl;
+    }
 }
 #endif
 
@@ -33,6 +64,12 @@ int main()
 #if __linux__
     // initialize kinect
     std::shared_ptr<Kinect> sptr_kinect(new Kinect);
+
+#define STREAM 0
+#if STREAM == 1
+    stream(sptr_kinect);
+    return 0;
+#endif
 #endif
 
 #if __linux__
@@ -2,26 +2,18 @@
 #include <opencv2/opencv.hpp>
 
 #if __linux__
+#include "frame.h"
 #include "kinect.h"
-cv::Mat grabFrame(std::shared_ptr<Kinect>& sptr_kinect)
+#include "plan.h"
+Frame grabFrame(std::shared_ptr<Kinect>& sptr_kinect)
 {
-    sptr_kinect->capture();
-    sptr_kinect->depthCapture();
-    sptr_kinect->pclCapture();
-    sptr_kinect->imgCapture();
-    sptr_kinect->c2dCapture();
-    sptr_kinect->transform(RGB_TO_DEPTH);
+    CapturePlan plan(sptr_kinect, COLOR_TO_DEPTH);
+    plan.capture();
 
-    auto* rgbData = k4a_image_get_buffer(sptr_kinect->m_c2d);
-    int w = k4a_image_get_width_pixels(sptr_kinect->m_c2d);
-    int h = k4a_image_get_height_pixels(sptr_kinect->m_c2d);
-
-    cv::Mat frame
-        = cv::Mat(h, w, CV_8UC4, (void*)rgbData, cv::Mat::AUTO_STEP).clone();
-
-    sptr_kinect->releaseK4aCapture();
-    sptr_kinect->releaseK4aImages();
+    // frame holds its own reference on the image: no copy needed
+    Frame frame(plan.c2d(), CV_8UC4);
 
+    plan.release();
     return frame;
 }
 #endif
@@ -1,71 +1,90 @@
 #include "scene.h"
+#include <iostream>
 #include <opencv2/opencv.hpp>
 
+#include "contrast.h"
+#include "convolve.h"
+#include "frame.h"
 #include "kinect.h"
+#include "plan.h"
+#include "pool.h"
+#include "tracker.h"
+
+Frame grabFrame(std::shared_ptr<Kinect>& sptr_kinect)
+{
+    CapturePlan plan(sptr_kinect, COLOR);
+    plan.capture();
+    Frame frame(sptr_kinect->m_img, CV_8UC4);
+    plan.release();
+    return frame;
+}
 
 void saturate(const cv::Mat& src, cv::Mat& dst)
 {
     int beta = 100;     // brightness | range 1 - 100
     double alpha = 3.0; // contrast | range 1.0 - 3.0]
 
-    dst = cv::Mat::zeros(src.size(), src.type());
-    for (int y = 0; y < src.rows; y++) {
-        for (int x = 0; x < src.cols; x++) {
-            for (int c = 0; c < src.channels(); c++) {
-                dst.at<cv::Vec3b>(y, x)[c] = cv::saturate_cast<uchar>(
-                    alpha * src.at<cv::Vec3b>(y, x)[c] + beta);
-            }
-        }
-    }
+    contrast::apply(src, dst, alpha, beta);
 }
 
-cv::Rect segment(const cv::Mat& src1, const cv::Mat& src2)
+cv::Rect segment(const cv::Mat& src1, const cv::Mat& src2, MatPool& pool)
 {
     cv::Mat background, foreground;
     foreground = src1;
     background = src2;
 
+    // every intermediate below is workspace drawn from the pool, which
+    // the caller resets once per frame
+    const cv::Size size = src1.size();
+    const int type = src1.type();
+
     // subtract images and contrast resulting image
-    cv::Mat diff, contrast;
-    diff = background - foreground;
+    cv::Mat diff = pool.acquire(size, type);
+    cv::Mat contrast = pool.acquire(size, type);
+    cv::subtract(background, foreground, diff);
     saturate(diff, contrast);
     // todo: undistort
 
     // split high contrast image
-    cv::Mat rgb[3];
-    cv::Mat bgr;
+    cv::Mat rgb[3] = { pool.acquire(size, CV_8UC1),
+        pool.acquire(size, CV_8UC1), pool.acquire(size, CV_8UC1) };
+    cv::Mat bgr = pool.acquire(size, CV_8UC3);
     cv::cvtColor(contrast, bgr, cv::COLOR_BGR2RGB);
 
     cv::split(bgr, rgb);
     // cv::equalizeHist(src, dst); // one other good approach to contrasting
 
     // threshold blue channel
-    cv::Mat thresh;
+    cv::Mat thresh = pool.acquire(size, CV_8UC1);
     cv::threshold(rgb[2], thresh, 0, 255, cv::THRESH_BINARY + cv::THRESH_OTSU);
 
     // clean using morphological operations
-    cv::Mat shape, proposal;
-    shape = cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(3, 3));
+    static const cv::Mat shape
+        = cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(3, 3));
+    cv::Mat proposal = pool.acquire(size, CV_8UC1);
     cv::morphologyEx(thresh, proposal, cv::MORPH_OPEN, shape);
 
     // de-noise
-    cv::Mat blur, secThresh;
-    cv::Size dBlur = cv::Size(75, 75);
-    cv::GaussianBlur(proposal, blur, dBlur, 0);
+    cv::Mat blur = pool.acquire(size, CV_8UC1);
+    cv::Mat secThresh = pool.acquire(size, CV_8UC1);
+    static Convolver gaussian(cv::Size(75, 75), 0);
+    gaussian.apply(proposal, blur);
 
     // threshold denoised frame
     cv::threshold(blur, secThresh, 0, 255, cv::THRESH_BINARY + cv::THRESH_OTSU);
 
     // flood fill
-    cv::Mat floodFill = secThresh.clone();
+    cv::Mat floodFill = pool.acquire(size, CV_8UC1);
+    secThresh.copyTo(floodFill);
     cv::floodFill(floodFill, cv::Point(0, 0), cv::Scalar(255));
 
     // invert flood fill
-    cv::Mat floodFillInv;
+    cv::Mat floodFillInv = pool.acquire(size, CV_8UC1);
     cv::bitwise_not(floodFill, floodFillInv);
 
     // combine threshold and flood fill inverse
-    cv::Mat roi = (secThresh | floodFillInv);
+    cv::Mat roi = pool.acquire(size, CV_8UC1);
+    cv::bitwise_or(secThresh, floodFillInv, roi);
 
 #define show 0
 #if show == 1
@@ -104,6 +123,198 @@ cv::Rect segment(const cv::Mat& src1, const cv::Mat& src2)
     return cv::boundingRect(roi);
 }
 
+// coarse pass runs LEVELS pyramid levels below full resolution
+static const int LEVELS = 2;
+
+// sigma cv::GaussianBlur derives for the 75x75 kernel used by segment()
+static const double BLUR_SIGMA = 0.3 * ((75 - 1) * 0.5 - 1) + 0.8;
+
+// contrasted blue-channel difference: the only channel segment() uses
+static void blueDiff(const cv::Mat& foreground, const cv::Mat& background,
+    cv::Mat& dst, cv::Mat& tmp)
+{
+    cv::extractChannel(background, dst, 0);
+    cv::extractChannel(foreground, tmp, 0);
+    cv::subtract(dst, tmp, dst);
+    saturate(dst, dst);
+}
+
+// snap the edges of a coarse boundary to the full resolution mask
+static cv::Rect refine(const cv::Mat& src1, const cv::Mat& src2,
+    const cv::Rect& coarse, const double& thresh, MatPool& pool)
+{
+    const int margin = 2 << LEVELS;
+    cv::Rect window = cv::Rect(coarse.x - margin, coarse.y - margin,
+                          coarse.width + 2 * margin, coarse.height + 2 * margin)
+        & cv::Rect(cv::Point(0, 0), src1.size());
+
+    cv::Mat diff = pool.acquire(window.size(), CV_8UC1);
+    cv::Mat tmp = pool.acquire(window.size(), CV_8UC1);
+    blueDiff(src1(window), src2(window), diff, tmp);
+    cv::threshold(diff, tmp, thresh, 255, cv::THRESH_BINARY);
+
+    static const cv::Mat shape
+        = cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(3, 3));
+    cv::morphologyEx(tmp, diff, cv::MORPH_OPEN, shape);
+
+    cv::Rect fine = cv::boundingRect(diff);
+    if (fine.empty()) {
+        return coarse;
+    }
+    return fine + window.tl();
+}
+
+// segment() on a downsampled pyramid level: single channel from the
+// start, box-cascade blur, then the boundary is refined at full res
+cv::Rect segmentFast(const cv::Mat& src1, const cv::Mat& src2, MatPool& pool)
+{
+    // blue channel difference at the coarse level
+    cv::Mat foreground = pool.acquire(src1.size(), CV_8UC1);
+    cv::Mat background = pool.acquire(src2.size(), CV_8UC1);
+    cv::extractChannel(src1, foreground, 0);
+    cv::extractChannel(src2, background, 0);
+    for (int i = 0; i < LEVELS; i++) {
+        cv::Size down((foreground.cols + 1) / 2, (foreground.rows + 1) / 2);
+        cv::Mat f = pool.acquire(down, CV_8UC1);
+        cv::Mat b = pool.acquire(down, CV_8UC1);
+        cv::pyrDown(foreground, f, down);
+        cv::pyrDown(background, b, down);
+        foreground = f;
+        background = b;
+    }
+    const cv::Size size = foreground.size();
+    cv::Mat diff = pool.acquire(size, CV_8UC1);
+    cv::subtract(background, foreground, diff);
+    saturate(diff, diff);
+
+    // threshold and clean
+    cv::Mat thresh = pool.acquire(size, CV_8UC1);
+    double otsu = cv::threshold(
+        diff, thresh, 0, 255, cv::THRESH_BINARY + cv::THRESH_OTSU);
+    static const cv::Mat shape
+        = cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(3, 3));
+    cv::Mat proposal = pool.acquire(size, CV_8UC1);
+    cv::morphologyEx(thresh, proposal, cv::MORPH_OPEN, shape);
+
+    // de-noise
+    cv::Mat blur = pool.acquire(size, CV_8UC1);
+    static Convolver gaussian(cv::Size(), BLUR_SIGMA / (1 << LEVELS), true);
+    gaussian.apply(proposal, blur, BOX_CASCADE);
+    cv::threshold(blur, thresh, 0, 255, cv::THRESH_BINARY + cv::THRESH_OTSU);
+
+    // flood fill, invert and combine
+    cv::Mat floodFill = pool.acquire(size, CV_8UC1);
+    thresh.copyTo(floodFill);
+    cv::floodFill(floodFill, cv::Point(0, 0), cv::Scalar(255));
+    cv::bitwise_not(floodFill, floodFill);
+    cv::bitwise_or(thresh, floodFill, floodFill);
+
+    cv::Rect coarse = cv::boundingRect(floodFill);
+    if (coarse.empty()) {
+        return coarse;
+    }
+    double sx = (double)src1.cols / size.width;
+    double sy = (double)src1.rows / size.height;
+    coarse = cv::Rect(cv::Point(cvFloor(coarse.x * sx), cvFloor(coarse.y * sy)),
+        cv::Point(cvCeil(coarse.br().x * sx), cvCeil(coarse.br().y * sy)));
+    return refine(src1, src2, coarse, otsu, pool);
+}
+
+// how far segmentFast() drifts from segment() on a pair of scenes
+void drift(const cv::Mat& src1, const cv::Mat& src2, MatPool& pool)
+{
+    int64 t0 = cv::getTickCount();
+    cv::Rect reference = segment(src1, src2, pool);
+    int64 t1 = cv::getTickCount();
+    cv::Rect fast = segmentFast(src1, src2, pool);
+    int64 t2 = cv::getTickCount();
+
+    int edge = std::max(std::max(std::abs(fast.x - reference.x),
+                            std::abs(fast.y - reference.y)),
+        std::max(std::abs(fast.br().x - reference.br().x),
+            std::abs(fast.br().y - reference.br().y)));
+    int area = (reference | fast).area();
+    double iou = area == 0 ? 1.0 : (double)(reference & fast).area() / area;
+
+    double ms = 1000.0 / cv::getTickFrequency();
+    std::cout << "-- segment: " << reference << " in " << (t1 - t0) * ms
+              << " ms" << std::endl;
+    std::cout << "-- fast segment: " << fast << " in " << (t2 - t1) * ms
+              << " ms" << std::endl;
+    std::cout << "-- drift: " << edge << " px (max edge), IoU " << iou
+              << std::endl;
+}
+
+// where each convolution method wins: mean time over a few runs for
+// growing gaussians on frame-sized single-channel images
+void crossover()
+{
+    const cv::Size sizes[] = { cv::Size(1280, 720), cv::Size(640, 576) };
+    const double sigmas[] = { 2, 4, 8, 16, 32 };
+    const Convolution methods[] = { SEPARABLE, BOX_CASCADE, FFT };
+    const int runs = 5;
+
+    for (const cv::Size& size : sizes) {
+        cv::Mat src(size, CV_8UC1), dst;
+        cv::randu(src, 0, 256);
+        std::cout << "-- " << size << std::endl;
+        for (const double& sigma : sigmas) {
+            Convolver convolver(cv::Size(), sigma, true);
+            std::cout << "   sigma " << sigma << " (" << convolver.ksize()
+                      << "):";
+            for (const Convolution& method : methods) {
+                convolver.apply(src, dst, method); // warm up the workspace
+                int64 t0 = cv::getTickCount();
+                for (int i = 0; i < runs; i++) {
+                    convolver.apply(src, dst, method);
+                }
+                double ms = (cv::getTickCount() - t0) * 1000.0
+                    / cv::getTickFrequency() / runs;
+                std::cout << " " << Convolver::name(method) << " " << ms
+                          << " ms,";
+            }
+            std::cout << " auto: "
+                      << Convolver::name(convolver.choose(size)) << std::endl;
+        }
+    }
+}
+
+// the LUT contrast kernel against the per-pixel loop it replaced, on
+// frame-sized 3-channel images; outputs must be bit-identical
+void contrastTiming()
+{
+    const double alpha = 3.0;
+    const int beta = 100;
+    const int runs = 20;
+    cv::Mat src(cv::Size(1280, 720), CV_8UC3), loop, lut;
+    cv::randu(src, 0, 256);
+
+    loop.create(src.size(), src.type());
+    int64 t0 = cv::getTickCount();
+    for (int run = 0; run < runs; run++) {
+        for (int y = 0; y < src.rows; y++) {
+            for (int x = 0; x < src.cols; x++) {
+                for (int c = 0; c < src.channels(); c++) {
+                    loop.at<cv::Vec3b>(y, x)[c] = cv::saturate_cast<uchar>(
+                        alpha * src.at<cv::Vec3b>(y, x)[c] + beta);
+                }
+            }
+        }
+    }
+    int64 t1 = cv::getTickCount();
+    for (int run = 0; run < runs; run++) {
+        contrast::apply(src, lut, alpha, beta);
+    }
+    int64 t2 = cv::getTickCount();
+
+    double ms = 1000.0 / cv::getTickFrequency() / runs;
+    std::cout << "-- contrast " << src.size() << ": loop " << (t1 - t0) * ms
+              << " ms, lut " << (t2 - t1) * ms << " ms, output "
+              << (cv::norm(loop, lut, cv::NORM_INF) == 0 ? "identical"
+                                                          : "DIFFERS")
+              << std::endl;
+}
+
 cv::Mat blackBackground(const cv::Mat& background, const cv::Mat& foreground,
     const cv::Rect& boundary)
 {
@@ -137,8 +348,38 @@ cv::Mat blackBackground(const cv::Mat& background, const cv::Mat& foreground,
     return blackMask;
 }
 
-int main()
+int main(int argc, char* argv[])
 {
+    MatPool pool;
+
+    // drift report on recorded scene pairs, e.g., the background and
+    // foreground images written by segment()
+    if (argc > 2) {
+        for (int i = 1; i + 1 < argc; i += 2) {
+            cv::Mat src1 = cv::imread(argv[i]);
+            cv::Mat src2 = cv::imread(argv[i + 1]);
+            if (src1.empty() || src2.empty()) {
+                std::cerr << "-- failed to read " << argv[i] << " or "
+                          << argv[i + 1] << std::endl;
+                return 1;
+            }
+            pool.reset();
+            drift(src1, src2, pool);
+        }
+        return 0;
+    }
+
+#define CROSSOVER 0
+#if CROSSOVER == 1
+    crossover();
+    return 0;
+#endif
+#define CONTRAST_TIMING 0
+#if CONTRAST_TIMING == 1
+    contrastTiming();
+    return 0;
+#endif
+
     // initialize kinect and scene container
     std::shared_ptr<Kinect> sptr_kinect(new Kinect);
     std::vector<cv::Mat> scene;
@@ -149,8 +390,32 @@ int main()
     const std::string window = "Area of projection";
     scene::alternateDisplayColor(sptr_kinect, window, w, h, scene);
 
-    // query roi for re-projection
-    cv::Rect boundary = segment(scene[0], scene[1]);
+    // query roi for re-projection: one pool frame per segmentation
+#define FAST_SEGMENT 1
+    auto segmentScene = [&]() {
+        pool.reset();
+#if FAST_SEGMENT == 1
+        return segmentFast(scene[0], scene[1], pool);
+#else
+        return segment(scene[0], scene[1], pool);
+#endif
+    };
+    cv::Rect boundary = segmentScene();
+
+    // the first frame fills the pool; later frames should allocate nothing
+    const size_t firstFrame = pool.allocations();
+    const int frames = 10;
+    for (int i = 0; i < frames; i++) {
+        segmentScene();
+    }
+    std::cout << "-- segmentation workspace: " << firstFrame
+              << " allocations on frame 1, "
+              << pool.allocations() - firstFrame << " over the next "
+              << frames << std::endl;
+#define DRIFT 0
+#if DRIFT == 1
+    drift(scene[0], scene[1], pool);
+#endif
     cv::Mat roi = scene[0](boundary);
     // cv::imshow("ROI", roi);
     cv::imwrite("./output/roi.png", roi);
@@ -160,5 +425,28 @@ int main()
     cv::imshow("test", roiBlackBackground);
     cv::imwrite("./output/roiBlacked.png", roiBlackBackground);
     cv::waitKey();
+
+#define TRACK 0
+#if TRACK == 1
+    // keep the boundary up to date, re-flashing only when its edges move
+    ProjectionTracker tracker([&]() {
+        scene.clear();
+        scene::alternateDisplayColor(sptr_kinect, window, w, h, scene);
+        return segmentScene();
+    });
+
+    // the boundary above is current: no flash for the first frame
+    tracker.seed(boundary);
+    while (cv::waitKey(1) != 27) {
+        Frame frame = grabFrame(sptr_kinect);
+        cv::Mat view = frame.mat().clone();
+        cv::rectangle(view, tracker.track(frame.mat()), cv::Scalar(0, 255, 0));
+        cv::imshow("tracked area of projection", view);
+    }
+    TrackerStats stats = tracker.stats();
+    std::cout << "-- tracker: " << stats.m_hits << " hits, " << stats.m_misses
+              << " misses (" << 100.0 * stats.hitRate() << "% hit rate)"
+              << std::endl;
+#endif
     return 0;
 }
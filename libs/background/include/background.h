@@ -0,0 +1,49 @@
+#ifndef BACKGROUND_H
+#define BACKGROUND_H
+
+#include <opencv2/core.hpp>
+
+struct BackgroundStats {
+    size_t m_frames;     // frames applied
+    double m_lastMs;     // cost of the last apply()
+    double m_meanMs;     // mean cost
+    double m_foreground; // foreground fraction of the last frame
+};
+
+/* streaming background model:
+ *   a per-pixel running average kept in fixed point (8 fractional bits,
+ *   int32 per channel) and updated every frame with
+ *
+ *       bg += (x - bg) >> shift
+ *
+ *   i.e., a learning rate of 2^-shift (4x slower under foreground, so
+ *   objects are absorbed gradually); a pixel is foreground when any
+ *   channel differs from the model by more than threshold. frames are
+ *   processed in parallel row tiles
+ *
+ *   inputs: CV_8UC1/3/4 color (alpha ignored), or CV_16UC1 depth (mm),
+ *   where zero depth is treated as a hole: never foreground, not learned
+ */
+class BackgroundModel {
+public:
+    explicit BackgroundModel(const int& threshold, const int& shift = 5);
+
+    // mask: CV_8UC1, 255 where foreground; the first frame (or a size or
+    // type change) initializes the model
+    void apply(const cv::Mat& frame, cv::Mat& mask);
+
+    // current model in the input's type
+    void background(cv::Mat& dst) const;
+
+    void reset() { m_model.release(); }
+
+    BackgroundStats stats() const { return m_stats; }
+
+private:
+    int m_threshold;
+    int m_shift;
+    int m_type;
+    cv::Mat m_model;
+    BackgroundStats m_stats;
+};
+#endif // BACKGROUND_H
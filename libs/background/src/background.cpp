@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <cstdlib>
+#include <opencv2/imgproc.hpp>
+
+#include "background.h"
+
+// fractional bits of the model
+static const int FRAC = 8;
+
+// rows per parallel tile
+static const int TILE_ROWS = 32;
+
+// extra shift applied under foreground: learn 4x slower there
+static const int FOREGROUND_SHIFT = 2;
+
+// T: input element, CN: input channels, USE: channels modelled
+template <typename T, int CN, int USE>
+static void applyRow(const T* in, int32_t* bg, uchar* mask, const int& width,
+    const int& threshold, const int& shift, const bool& depth)
+{
+    for (int x = 0; x < width; x++) {
+        const T* p = in + CN * x;
+        int32_t* b = bg + USE * x;
+
+        if (depth && (p[0] == 0 || b[0] == 0)) {
+            // hole, or first valid sample: (re)seed and stay background
+            if (p[0] != 0) {
+                b[0] = (int32_t)p[0] << FRAC;
+            }
+            mask[x] = 0;
+            continue;
+        }
+
+        int32_t diff = 0;
+        for (int c = 0; c < USE; c++) {
+            diff = std::max(diff, std::abs(((int32_t)p[c] << FRAC) - b[c]));
+        }
+        const bool foreground = (diff >> FRAC) > threshold;
+        const int s = foreground ? shift + FOREGROUND_SHIFT : shift;
+        for (int c = 0; c < USE; c++) {
+            b[c] += (((int32_t)p[c] << FRAC) - b[c]) >> s;
+        }
+        mask[x] = foreground ? 255 : 0;
+    }
+}
+
+template <typename T, int CN, int USE>
+static void applyTiles(const cv::Mat& frame, cv::Mat& model, cv::Mat& mask,
+    const int& threshold, const int& shift, const bool& depth)
+{
+    cv::parallel_for_(
+        cv::Range(0, frame.rows),
+        [&](const cv::Range& rows) {
+            for (int y = rows.start; y < rows.end; y++) {
+                applyRow<T, CN, USE>(frame.ptr<T>(y), model.ptr<int32_t>(y),
+                    mask.ptr<uchar>(y), frame.cols, threshold, shift, depth);
+            }
+        },
+        (double)frame.rows / TILE_ROWS);
+}
+
+// modelled channels of an input: alpha is dropped
+static int modelled(const int& type)
+{
+    return std::min(3, CV_MAT_CN(type));
+}
+
+BackgroundModel::BackgroundModel(const int& threshold, const int& shift)
+    : m_threshold(threshold)
+    , m_shift(shift)
+    , m_type(-1)
+    , m_stats { 0, 0.0, 0.0, 0.0 }
+{
+}
+
+void BackgroundModel::apply(const cv::Mat& frame, cv::Mat& mask)
+{
+    int64 start = cv::getTickCount();
+    const int type = frame.type();
+    CV_Assert(type == CV_8UC1 || type == CV_8UC3 || type == CV_8UC4
+        || type == CV_16UC1);
+
+    mask.create(frame.size(), CV_8UC1);
+    if (m_model.empty() || m_model.size() != frame.size() || m_type != type) {
+        // seed the model with this frame
+        m_type = type;
+        cv::Mat seed = frame;
+        if (CV_MAT_CN(type) == 4) {
+            cv::cvtColor(frame, seed, cv::COLOR_BGRA2BGR);
+        }
+        seed.convertTo(m_model, CV_32SC(modelled(type)), 1 << FRAC);
+    }
+
+    switch (type) {
+    case CV_8UC1:
+        applyTiles<uchar, 1, 1>(
+            frame, m_model, mask, m_threshold, m_shift, false);
+        break;
+    case CV_8UC3:
+        applyTiles<uchar, 3, 3>(
+            frame, m_model, mask, m_threshold, m_shift, false);
+        break;
+    case CV_8UC4:
+        applyTiles<uchar, 4, 3>(
+            frame, m_model, mask, m_threshold, m_shift, false);
+        break;
+    default:
+        applyTiles<uint16_t, 1, 1>(
+            frame, m_model, mask, m_threshold, m_shift, true);
+    }
+
+    double ms = (double)(cv::getTickCount() - start) * 1000.0
+        / cv::getTickFrequency();
+    m_stats.m_frames++;
+    m_stats.m_lastMs = ms;
+    m_stats.m_meanMs += (ms - m_stats.m_meanMs) / (double)m_stats.m_frames;
+    m_stats.m_foreground
+        = (double)cv::countNonZero(mask) / (double)mask.total();
+}
+
+void BackgroundModel::background(cv::Mat& dst) const
+{
+    if (m_model.empty()) {
+        dst.release();
+        return;
+    }
+    const int depth = m_type == CV_16UC1 ? CV_16U : CV_8U;
+    m_model.convertTo(dst, CV_MAKETYPE(depth, m_model.channels()),
+        1.0 / (1 << FRAC));
+}
@@ -0,0 +1,30 @@
+#ifndef COMPOSITE_H
+#define COMPOSITE_H
+
+#include <opencv2/core.hpp>
+
+/* single-pass 8-bit compositing kernels:
+ *   over  : foreground wins wherever any of its channels is non-zero,
+ *           background elsewhere
+ *   blend : alpha-blends a BGRA foreground over a BGR or BGRA background
+ *
+ *   each kernel reads every input pixel once and writes the result in the
+ *   same pass, row-parallel, into a caller-owned destination that may
+ *   alias the background
+ */
+namespace composite {
+
+// foreground and background share size and type
+void over(const cv::Mat& foreground, const cv::Mat& background, cv::Mat& dst);
+
+// dst holds the background; only pixels inside box are touched
+void over(const cv::Mat& foreground, cv::Mat& dst, const cv::Rect& box);
+
+// dst = (a * fg + (255 - a) * bg) / 255, rounded
+void blend(const cv::Mat& foreground, const cv::Mat& background, cv::Mat& dst);
+
+// blend a (smaller) BGRA foreground into dst with its top-left corner at
+// tl; parts falling outside dst are clipped
+void blend(const cv::Mat& foreground, cv::Mat& dst, const cv::Point& tl);
+}
+#endif // COMPOSITE_H
@@ -0,0 +1,141 @@
+#include "composite.h"
+
+// rows handed to one parallel_for_ stripe
+static const int STRIPE_ROWS = 16;
+
+// x / 255, rounded, for x in [0, 255 * 255]
+static inline uint32_t div255(const uint32_t& x)
+{
+    return (x + 128 + ((x + 128) >> 8)) >> 8;
+}
+
+// branch-free select, written so the row loop auto-vectorizes
+template <int CN>
+static void overRow(
+    const uchar* fg, const uchar* bg, uchar* dst, const int& width)
+{
+    for (int x = 0; x < width; x++) {
+        uchar any = 0;
+        for (int c = 0; c < CN; c++) {
+            any |= fg[CN * x + c];
+        }
+        const uchar mask = (uchar)-(uchar)(any != 0);
+        for (int c = 0; c < CN; c++) {
+            dst[CN * x + c] = (uchar)((fg[CN * x + c] & mask)
+                | (bg[CN * x + c] & (uchar)~mask));
+        }
+    }
+}
+
+static void overRow(const uchar* fg, const uchar* bg, uchar* dst,
+    const int& width, const int& channels)
+{
+    switch (channels) {
+    case 1:
+        overRow<1>(fg, bg, dst, width);
+        break;
+    case 3:
+        overRow<3>(fg, bg, dst, width);
+        break;
+    case 4:
+        overRow<4>(fg, bg, dst, width);
+        break;
+    default:
+        CV_Error(cv::Error::StsUnsupportedFormat, "composite: channels");
+    }
+}
+
+// bg and dst have CN channels, fg is always BGRA
+template <int CN>
+static void blendRow(
+    const uchar* fg, const uchar* bg, uchar* dst, const int& width)
+{
+    for (int x = 0; x < width; x++) {
+        const uint32_t a = fg[4 * x + 3];
+        for (int c = 0; c < 3; c++) {
+            dst[CN * x + c] = (uchar)div255(
+                a * fg[4 * x + c] + (255 - a) * bg[CN * x + c]);
+        }
+        if (CN == 4) {
+            dst[CN * x + 3] = (uchar)div255(
+                a * 255 + (255 - a) * bg[CN * x + 3]);
+        }
+    }
+}
+
+static void blendRow(const uchar* fg, const uchar* bg, uchar* dst,
+    const int& width, const int& channels)
+{
+    if (channels == 3) {
+        blendRow<3>(fg, bg, dst, width);
+    } else {
+        blendRow<4>(fg, bg, dst, width);
+    }
+}
+
+void composite::over(
+    const cv::Mat& foreground, const cv::Mat& background, cv::Mat& dst)
+{
+    CV_Assert(foreground.size() == background.size()
+        && foreground.type() == background.type()
+        && foreground.depth() == CV_8U);
+    dst.create(background.size(), background.type());
+
+    const int width = background.cols;
+    const int channels = background.channels();
+    cv::parallel_for_(
+        cv::Range(0, background.rows),
+        [&](const cv::Range& rows) {
+            for (int y = rows.start; y < rows.end; y++) {
+                overRow(foreground.ptr(y), background.ptr(y), dst.ptr(y),
+                    width, channels);
+            }
+        },
+        (double)background.rows / STRIPE_ROWS);
+}
+
+void composite::over(
+    const cv::Mat& foreground, cv::Mat& dst, const cv::Rect& box)
+{
+    CV_Assert(foreground.size() == dst.size()
+        && foreground.type() == dst.type());
+    cv::Rect roi = box & cv::Rect(cv::Point(0, 0), dst.size());
+    if (roi.empty()) {
+        return;
+    }
+    cv::Mat out = dst(roi);
+    over(foreground(roi), out, out);
+}
+
+void composite::blend(
+    const cv::Mat& foreground, const cv::Mat& background, cv::Mat& dst)
+{
+    CV_Assert(foreground.size() == background.size()
+        && foreground.type() == CV_8UC4
+        && (background.type() == CV_8UC3 || background.type() == CV_8UC4));
+    dst.create(background.size(), background.type());
+
+    const int width = background.cols;
+    const int channels = background.channels();
+    cv::parallel_for_(
+        cv::Range(0, background.rows),
+        [&](const cv::Range& rows) {
+            for (int y = rows.start; y < rows.end; y++) {
+                blendRow(foreground.ptr(y), background.ptr(y), dst.ptr(y),
+                    width, channels);
+            }
+        },
+        (double)background.rows / STRIPE_ROWS);
+}
+
+void composite::blend(
+    const cv::Mat& foreground, cv::Mat& dst, const cv::Point& tl)
+{
+    cv::Rect placed(tl, foreground.size());
+    cv::Rect roi = placed & cv::Rect(cv::Point(0, 0), dst.size());
+    if (roi.empty()) {
+        return;
+    }
+    cv::Mat out = dst(roi);
+    blend(foreground(roi - tl), out, out);
+}
@@ -0,0 +1,24 @@
+#ifndef CONTRAST_H
+#define CONTRAST_H
+
+#include <opencv2/core.hpp>
+
+/* brightness/contrast kernel:
+ *   dst = saturate_cast<uchar>(alpha * src + beta), for 8-bit images with
+ *   any number of channels. the 256 possible results are tabulated once
+ *   per (alpha, beta) and applied with cv::LUT, which is vectorized and
+ *   runs row-parallel; results match the per-pixel expression exactly
+ */
+namespace contrast {
+
+// 1x256 CV_8UC1 lookup table for (alpha, beta)
+cv::Mat table(const double& alpha, const int& beta);
+
+// dst may alias src; dst is only (re)allocated if its size or type differ
+void apply(const cv::Mat& src, cv::Mat& dst, const cv::Mat& table);
+
+// same as above, reusing the last table built on the calling thread
+void apply(
+    const cv::Mat& src, cv::Mat& dst, const double& alpha, const int& beta);
+}
+#endif // CONTRAST_H
@@ -0,0 +1,35 @@
+#include <opencv2/core.hpp>
+
+#include "contrast.h"
+
+cv::Mat contrast::table(const double& alpha, const int& beta)
+{
+    cv::Mat lut(1, 256, CV_8UC1);
+    uchar* p = lut.ptr<uchar>();
+    for (int i = 0; i < 256; i++) {
+        p[i] = cv::saturate_cast<uchar>(alpha * i + beta);
+    }
+    return lut;
+}
+
+void contrast::apply(const cv::Mat& src, cv::Mat& dst, const cv::Mat& table)
+{
+    CV_Assert(src.depth() == CV_8U);
+    cv::LUT(src, table, dst);
+}
+
+void contrast::apply(
+    const cv::Mat& src, cv::Mat& dst, const double& alpha, const int& beta)
+{
+    // callers typically fix (alpha, beta), so the table is built once
+    thread_local double cachedAlpha = 0.0;
+    thread_local int cachedBeta = 0;
+    thread_local cv::Mat cachedTable;
+
+    if (cachedTable.empty() || cachedAlpha != alpha || cachedBeta != beta) {
+        cachedTable = table(alpha, beta);
+        cachedAlpha = alpha;
+        cachedBeta = beta;
+    }
+    apply(src, dst, cachedTable);
+}
@@ -0,0 +1,73 @@
+#ifndef CONVOLVE_H
+#define CONVOLVE_H
+
+#include <map>
+#include <opencv2/core.hpp>
+
+/* large-kernel convolution engine:
+ *   applies a separable kernel (e.g., a gaussian) with whichever method
+ *   is cheapest for the kernel and image size
+ *
+ *   SEPARABLE   : two 1D passes, cost ~ kernel width + height per pixel,
+ *                 more where the kernel overlaps the border
+ *   BOX_CASCADE : three box passes per axis, cost independent of the
+ *                 kernel; gaussians only, and only an approximation
+ *   FFT         : overlap-add over tiles, cost ~ log(tile) per pixel;
+ *                 kernel spectra are cached per tile size
+ *
+ *   crossovers of the cost model, fitted to single-core timings of
+ *   square kernels on 8-bit images: FFT beats SEPARABLE from 79 px on
+ *   1280x720, 73 px on 640x576 and 55 px on 320x288; BOX_CASCADE beats
+ *   SEPARABLE from about 11 px
+ *
+ *   all methods use cv::BORDER_REFLECT_101, like cv::GaussianBlur
+ */
+enum Convolution { AUTO, SEPARABLE, BOX_CASCADE, FFT };
+
+class Convolver {
+public:
+    // the gaussian cv::GaussianBlur(ksize, sigma) would apply (either may
+    // be zero, and is then derived from the other); approximate: allow
+    // AUTO to pick BOX_CASCADE
+    Convolver(const cv::Size& ksize, const double& sigma,
+        const bool& approximate = false);
+
+    // the separable kernel ky * kx^T
+    Convolver(const cv::Mat& kx, const cv::Mat& ky);
+
+    // dst has src's size and type; FFT needs single-channel images
+    void apply(const cv::Mat& src, cv::Mat& dst,
+        const Convolution& method = AUTO);
+
+    // cheapest method for an image size, by a per-pixel cost model
+    Convolution choose(const cv::Size& size, const int& channels = 1) const;
+
+    const cv::Size& ksize() const { return m_ksize; }
+
+    static const char* name(const Convolution& method);
+
+private:
+    void separable(const cv::Mat& src, cv::Mat& dst) const;
+    void boxCascade(const cv::Mat& src, cv::Mat& dst);
+    void fft(const cv::Mat& src, cv::Mat& dst);
+
+    int tileSize(const cv::Size& size) const;
+    const cv::Mat& kernelSpectrum(const int& n);
+
+    cv::Mat m_kx;
+    cv::Mat m_ky;
+    cv::Size m_ksize;
+    cv::Point2d m_sigma; // gaussian only (0: not a gaussian)
+    bool m_approximate;
+
+    // workspace, reused across frames
+    cv::Mat m_float;
+    cv::Mat m_padded;
+    cv::Mat m_tile;
+    cv::Mat m_spectrum;
+    cv::Mat m_result;
+    cv::Mat m_sum;
+    cv::Mat m_box;
+    std::map<int, cv::Mat> m_spectra;
+};
+#endif // CONVOLVE_H
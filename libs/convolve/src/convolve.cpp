@@ -0,0 +1,257 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <opencv2/imgproc.hpp>
+
+#include "convolve.h"
+
+// per-pixel costs of the cost model, in separable taps (~0.14 ns on one
+// core): a tap, and the extra a tap costs within a kernel radius of the
+// border; one butterfly of the transforms, the spectrum multiply and tile
+// bookkeeping per tile pixel, and the conversions and padding per frame
+// pixel. measured with the crossover benchmark in example-15
+static const double TAP_COST = 1.0;
+static const double BORDER_COST = 8.0;
+static const double FFT_COST = 4.0;
+static const double MUL_COST = 16.0;
+static const double FRAME_COST = 7.0;
+
+// box cascade: three cv::blur passes per axis, each a running sum
+// (~3 ns per pixel, whatever the kernel)
+static const int BOX_PASSES = 3;
+static const double BOX_COST = 21.0;
+
+// fft tile sizes considered
+static const int TILES[] = { 128, 256, 512, 1024, 2048 };
+
+// the box widths of a BOX_PASSES cascade matching a gaussian's sigma:
+// the two odd widths bracketing the ideal one, split so the cascade's
+// variance matches
+static void boxWidths(const double& sigma, int widths[BOX_PASSES])
+{
+    const double variance = 12.0 * sigma * sigma;
+    double ideal = std::sqrt(variance / BOX_PASSES + 1.0);
+    int lower = (int)ideal % 2 == 0 ? (int)ideal - 1 : (int)ideal;
+    int upper = lower + 2;
+    int nLower = (int)std::round(
+        (variance - BOX_PASSES * lower * lower - 4.0 * BOX_PASSES * lower
+            - 3.0 * BOX_PASSES)
+        / (-4.0 * lower - 4.0));
+    for (int i = 0; i < BOX_PASSES; i++) {
+        widths[i] = i < nLower ? lower : upper;
+    }
+}
+
+// cv::GaussianBlur's size/sigma defaults (8-bit images)
+static int gaussianSize(const int& ksize, const double& sigma)
+{
+    return ksize > 0 ? ksize : (cvRound(sigma * 3 * 2 + 1) | 1);
+}
+
+static double gaussianSigma(const int& ksize, const double& sigma)
+{
+    return sigma > 0 ? sigma : 0.3 * ((ksize - 1) * 0.5 - 1) + 0.8;
+}
+
+Convolver::Convolver(
+    const cv::Size& ksize, const double& sigma, const bool& approximate)
+    : m_approximate(approximate)
+{
+    CV_Assert(ksize.width > 0 || sigma > 0);
+    m_ksize.width = gaussianSize(ksize.width, sigma);
+    m_ksize.height = gaussianSize(ksize.height, sigma);
+    m_sigma.x = gaussianSigma(m_ksize.width, sigma);
+    m_sigma.y = gaussianSigma(m_ksize.height, sigma);
+    m_kx = cv::getGaussianKernel(m_ksize.width, m_sigma.x, CV_32F);
+    m_ky = cv::getGaussianKernel(m_ksize.height, m_sigma.y, CV_32F);
+}
+
+Convolver::Convolver(const cv::Mat& kx, const cv::Mat& ky)
+    : m_ksize((int)kx.total(), (int)ky.total())
+    , m_sigma(0, 0)
+    , m_approximate(false)
+{
+    kx.reshape(1, (int)kx.total()).convertTo(m_kx, CV_32F);
+    ky.reshape(1, (int)ky.total()).convertTo(m_ky, CV_32F);
+}
+
+const char* Convolver::name(const Convolution& method)
+{
+    switch (method) {
+    case SEPARABLE:
+        return "separable";
+    case BOX_CASCADE:
+        return "box cascade";
+    case FFT:
+        return "fft";
+    default:
+        return "auto";
+    }
+}
+
+int Convolver::tileSize(const cv::Size& size) const
+{
+    // fewest butterflies per output pixel over the candidate tiles
+    const cv::Size padded = size + m_ksize - cv::Size(1, 1);
+    int best = 0;
+    double cheapest = DBL_MAX;
+    for (const int& n : TILES) {
+        int t = n - std::max(m_ksize.width, m_ksize.height) + 1;
+        if (t < n / 4) {
+            continue; // mostly kernel padding
+        }
+        double tiles = std::ceil((double)padded.width / t)
+            * std::ceil((double)padded.height / t);
+        double cost = tiles * (double)n * n * std::log2((double)n * n);
+        if (cost < cheapest) {
+            cheapest = cost;
+            best = n;
+        }
+    }
+    return best;
+}
+
+Convolution Convolver::choose(const cv::Size& size, const int& channels) const
+{
+    const double pixels = (double)size.area();
+    const double border = (double)m_ksize.width / size.width
+        + (double)m_ksize.height / size.height;
+    double separable = (m_ksize.width + m_ksize.height)
+        * (TAP_COST + BORDER_COST * border);
+    Convolution method = SEPARABLE;
+    double cheapest = separable;
+
+    if (m_approximate && m_sigma.x > 0 && BOX_COST < cheapest) {
+        method = BOX_CASCADE;
+        cheapest = BOX_COST;
+    }
+
+    const int n = tileSize(size);
+    if (channels == 1 && n > 0) {
+        const int t = n - std::max(m_ksize.width, m_ksize.height) + 1;
+        double tiles = std::ceil((double)(size.width + m_ksize.width - 1) / t)
+            * std::ceil((double)(size.height + m_ksize.height - 1) / t);
+        double butterflies = 2.0 * n * n * std::log2((double)n * n);
+        double fft = tiles * (FFT_COST * butterflies + MUL_COST * n * n)
+                / pixels
+            + FRAME_COST;
+        if (fft < cheapest) {
+            method = FFT;
+        }
+    }
+    return method;
+}
+
+void Convolver::apply(
+    const cv::Mat& src, cv::Mat& dst, const Convolution& method)
+{
+    Convolution chosen
+        = method == AUTO ? choose(src.size(), src.channels()) : method;
+    switch (chosen) {
+    case BOX_CASCADE:
+        CV_Assert(m_sigma.x > 0);
+        boxCascade(src, dst);
+        break;
+    case FFT:
+        fft(src, dst);
+        break;
+    default:
+        separable(src, dst);
+    }
+}
+
+void Convolver::separable(const cv::Mat& src, cv::Mat& dst) const
+{
+    if (m_sigma.x > 0) {
+        // gaussians go through the fixed-point 8-bit path of GaussianBlur
+        cv::GaussianBlur(src, dst, m_ksize, m_sigma.x, m_sigma.y);
+        return;
+    }
+    cv::sepFilter2D(src, dst, -1, m_kx, m_ky, cv::Point(-1, -1), 0,
+        cv::BORDER_REFLECT_101);
+}
+
+void Convolver::boxCascade(const cv::Mat& src, cv::Mat& dst)
+{
+    int wx[BOX_PASSES];
+    int wy[BOX_PASSES];
+    boxWidths(m_sigma.x, wx);
+    boxWidths(m_sigma.y, wy);
+
+    // ping-pong between dst and the workspace, ending in dst
+    const cv::Mat* in = &src;
+    for (int i = 0; i < BOX_PASSES; i++) {
+        cv::Mat& out = (BOX_PASSES - 1 - i) % 2 == 0 ? dst : m_box;
+        cv::blur(*in, out, cv::Size(wx[i], wy[i]), cv::Point(-1, -1),
+            cv::BORDER_REFLECT_101);
+        in = &out;
+    }
+}
+
+const cv::Mat& Convolver::kernelSpectrum(const int& n)
+{
+    auto cached = m_spectra.find(n);
+    if (cached != m_spectra.end()) {
+        return cached->second;
+    }
+
+    // the flipped 2D kernel at the origin: correlation as convolution
+    cv::Mat kernel = m_ky * m_kx.t();
+    cv::flip(kernel, kernel, -1);
+    cv::Mat padded = cv::Mat::zeros(n, n, CV_32FC1);
+    kernel.copyTo(padded(cv::Rect(cv::Point(0, 0), m_ksize)));
+
+    cv::Mat spectrum;
+    cv::dft(padded, spectrum, 0, m_ksize.height);
+    return m_spectra.emplace(n, spectrum).first->second;
+}
+
+void Convolver::fft(const cv::Mat& src, cv::Mat& dst)
+{
+    CV_Assert(src.channels() == 1);
+    const int kw = m_ksize.width;
+    const int kh = m_ksize.height;
+    const int n = tileSize(src.size());
+    CV_Assert(n > 0);
+    const int t = n - std::max(kw, kh) + 1;
+
+    // reflect the border in: the 'valid' correlation of the padded image
+    // is then the 'same' result of the spatial methods
+    src.convertTo(m_float, CV_32F);
+    cv::copyMakeBorder(m_float, m_padded, kh / 2, kh - 1 - kh / 2, kw / 2,
+        kw - 1 - kw / 2, cv::BORDER_REFLECT_101);
+
+    const cv::Mat& kernel = kernelSpectrum(n);
+    m_sum.create(src.size(), CV_32FC1);
+    m_sum.setTo(0);
+    m_tile.create(n, n, CV_32FC1);
+
+    // overlap-add: each tile's full correlation lands at its offset
+    for (int ty = 0; ty < m_padded.rows; ty += t) {
+        for (int tx = 0; tx < m_padded.cols; tx += t) {
+            const int th = std::min(t, m_padded.rows - ty);
+            const int tw = std::min(t, m_padded.cols - tx);
+
+            m_tile.setTo(0);
+            m_padded(cv::Rect(tx, ty, tw, th))
+                .copyTo(m_tile(cv::Rect(0, 0, tw, th)));
+            cv::dft(m_tile, m_spectrum, 0, th);
+            cv::mulSpectrums(m_spectrum, kernel, m_spectrum, 0);
+            cv::dft(m_spectrum, m_result,
+                cv::DFT_INVERSE | cv::DFT_REAL_OUTPUT | cv::DFT_SCALE);
+
+            // result (u, v) is output (tx + u - kw + 1, ty + v - kh + 1)
+            const int x0 = std::max(0, tx - kw + 1);
+            const int y0 = std::max(0, ty - kh + 1);
+            const int x1 = std::min(m_sum.cols, tx + tw);
+            const int y1 = std::min(m_sum.rows, ty + th);
+            if (x1 <= x0 || y1 <= y0) {
+                continue;
+            }
+            cv::Mat out = m_sum(cv::Rect(x0, y0, x1 - x0, y1 - y0));
+            out += m_result(cv::Rect(
+                x0 - (tx - kw + 1), y0 - (ty - kh + 1), x1 - x0, y1 - y0));
+        }
+    }
+    m_sum.convertTo(dst, src.type());
+}
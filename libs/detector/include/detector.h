@@ -0,0 +1,66 @@
+#ifndef DETECTOR_H
+#define DETECTOR_H
+
+#include <atomic>
+#include <mutex>
+#include <opencv2/core.hpp>
+#include <thread>
+#include <vector>
+
+#include "ring.h"
+
+struct Detection {
+    uint64_t m_sequence; // submission the result belongs to (0: none yet)
+    bool m_found;
+    std::vector<cv::Point2f> m_corners; // full resolution (sub-pixel if found)
+    cv::Mat m_frame;                    // the frame that was searched
+    double m_ms;                        // detection latency
+};
+
+/* background chessboard detection:
+ *   submit() hands a frame to a pool of workers and returns at once; only
+ *   the newest pending frame is kept, so a slow search never queues up
+ *   stale frames, and latest() returns the newest finished result
+ *
+ *   each search runs findChessboardCorners with fast-check on a
+ *   downscaled frame, and refines with cornerSubPix at full resolution
+ *   only on a hit
+ */
+class ChessboardDetector {
+public:
+    explicit ChessboardDetector(const cv::Size& dChessboard,
+        const int& workers = 2, const double& scale = 0.5);
+    ~ChessboardDetector();
+
+    ChessboardDetector(const ChessboardDetector&) = delete;
+    ChessboardDetector& operator=(const ChessboardDetector&) = delete;
+
+    // frame is copied: views over k4a buffers may be submitted
+    void submit(const cv::Mat& frame);
+
+    Detection latest() const;
+
+    // synchronous search, e.g., to verify the exact frame being captured
+    static Detection detect(
+        const cv::Mat& frame, const cv::Size& dChessboard, const double& scale);
+
+private:
+    struct Job {
+        uint64_t m_sequence;
+        cv::Mat m_frame;
+    };
+
+    void work();
+
+    cv::Size m_dChessboard;
+    double m_scale;
+    uint64_t m_submitted;
+
+    Ring<Job> m_jobs;
+    std::atomic<bool> m_running;
+    std::vector<std::thread> m_workers;
+
+    mutable std::mutex m_mutex;
+    Detection m_latest;
+};
+#endif // DETECTOR_H
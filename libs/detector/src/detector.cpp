@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <opencv2/calib3d.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "detector.h"
+
+// how long an idle worker parks before re-checking for shutdown
+static const int IDLE_MS = 100;
+
+ChessboardDetector::ChessboardDetector(
+    const cv::Size& dChessboard, const int& workers, const double& scale)
+    : m_dChessboard(dChessboard)
+    , m_scale(scale)
+    , m_submitted(0)
+    , m_jobs(1, LATEST_ONLY)
+    , m_running(true)
+    , m_latest { 0, false, {}, cv::Mat(), 0.0 }
+{
+    for (int i = 0; i < std::max(1, workers); i++) {
+        m_workers.emplace_back([this]() { work(); });
+    }
+}
+
+ChessboardDetector::~ChessboardDetector()
+{
+    m_running = false;
+    m_jobs.close();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void ChessboardDetector::submit(const cv::Mat& frame)
+{
+    m_jobs.push({ ++m_submitted, frame.clone() });
+}
+
+Detection ChessboardDetector::latest() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_latest;
+}
+
+void ChessboardDetector::work()
+{
+    Job job {};
+    while (m_running) {
+        if (!m_jobs.pop(job, IDLE_MS)) {
+            continue;
+        }
+        Detection detection = detect(job.m_frame, m_dChessboard, m_scale);
+        detection.m_sequence = job.m_sequence;
+
+        // workers may finish out of order: keep the newest submission
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (detection.m_sequence > m_latest.m_sequence) {
+            m_latest = std::move(detection);
+        }
+    }
+}
+
+Detection ChessboardDetector::detect(
+    const cv::Mat& frame, const cv::Size& dChessboard, const double& scale)
+{
+    int64 start = cv::getTickCount();
+    Detection detection { 0, false, {}, frame, 0.0 };
+
+    cv::Mat gray;
+    switch (frame.channels()) {
+    case 4:
+        cv::cvtColor(frame, gray, cv::COLOR_BGRA2GRAY);
+        break;
+    case 3:
+        cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
+        break;
+    default:
+        gray = frame;
+    }
+
+    // coarse search: boards are rejected cheaply by the fast check
+    cv::Mat small;
+    cv::resize(gray, small, cv::Size(), scale, scale, cv::INTER_AREA);
+    detection.m_found = cv::findChessboardCorners(small, dChessboard,
+        detection.m_corners,
+        cv::CALIB_CB_ADAPTIVE_THRESH + cv::CALIB_CB_NORMALIZE_IMAGE
+            + cv::CALIB_CB_FAST_CHECK);
+
+    // back to full resolution pixel centers: partial corners of a failed
+    // search too, since previews draw them
+    for (auto& corner : detection.m_corners) {
+        corner.x = (float)((corner.x + 0.5) / scale - 0.5);
+        corner.y = (float)((corner.y + 0.5) / scale - 0.5);
+    }
+    if (detection.m_found) {
+        cv::cornerSubPix(gray, detection.m_corners, cv::Size(11, 11),
+            cv::Size(-1, -1),
+            cv::TermCriteria(
+                cv::TermCriteria::EPS + cv::TermCriteria::COUNT, 30, 0.1));
+    }
+    detection.m_ms = (double)(cv::getTickCount() - start) * 1000.0
+        / cv::getTickFrequency();
+    return detection;
+}
@@ -0,0 +1,33 @@
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <k4a/k4a.h>
+#include <memory>
+#include <opencv2/core.hpp>
+#include <type_traits>
+
+/* zero-copy k4a image:
+ *   a frame holds its own reference on the k4a image and exposes the image
+ *   buffer as a cv::Mat view; copies of a frame share that reference, and
+ *   the image is released once the last copy goes away
+ *
+ *   n.b., mat() is only valid while a frame referencing it is alive, so
+ *   clone() it before storing it beyond the frame's lifetime
+ */
+class Frame {
+public:
+    Frame() = default;
+
+    Frame(k4a_image_t image, const int& type);
+
+    const cv::Mat& mat() const { return m_mat; }
+
+    bool empty() const { return m_mat.empty(); }
+
+    uint64_t timestamp() const;
+
+private:
+    std::shared_ptr<std::remove_pointer<k4a_image_t>::type> m_image;
+    cv::Mat m_mat;
+};
+#endif // FRAME_H
@@ -0,0 +1,22 @@
+#include "frame.h"
+
+Frame::Frame(k4a_image_t image, const int& type)
+{
+    if (image == nullptr) {
+        return;
+    }
+    k4a_image_reference(image);
+    m_image = std::shared_ptr<std::remove_pointer<k4a_image_t>::type>(
+        image, k4a_image_release);
+
+    uint8_t* data = k4a_image_get_buffer(image);
+    int w = k4a_image_get_width_pixels(image);
+    int h = k4a_image_get_height_pixels(image);
+    auto stride = (size_t)k4a_image_get_stride_bytes(image);
+    m_mat = cv::Mat(h, w, type, (void*)data, stride);
+}
+
+uint64_t Frame::timestamp() const
+{
+    return m_image ? k4a_image_get_device_timestamp_usec(m_image.get()) : 0;
+}
@@ -0,0 +1,20 @@
+#ifndef GEOMETRY_H
+#define GEOMETRY_H
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+/* projective warps:
+ *   a homography usually maps a small source onto a much larger canvas,
+ *   so only the part of the canvas the source can land on is warped
+ */
+namespace geometry {
+
+// warpPerspective(src, H) onto a canvas of the given size, but computing
+// only the bounding box of src's projected corners: dst receives the
+// box-sized patch and the box (its offset on the canvas) is returned,
+// e.g., for composite::over; an empty box means nothing lands on canvas
+cv::Rect warp(const cv::Mat& src, const cv::Mat& H, const cv::Size& canvas,
+    cv::Mat& dst, const int& flags = cv::INTER_LINEAR);
+}
+#endif // GEOMETRY_H
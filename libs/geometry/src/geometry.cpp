@@ -0,0 +1,51 @@
+#include <algorithm>
+#include <cfloat>
+#include <opencv2/imgproc.hpp>
+
+#include "geometry.h"
+
+cv::Rect geometry::warp(const cv::Mat& src, const cv::Mat& H,
+    const cv::Size& canvas, cv::Mat& dst, const int& flags)
+{
+    const cv::Rect image(cv::Point(0, 0), canvas);
+    cv::Mat values;
+    H.convertTo(values, CV_64F);
+    const cv::Matx33d M((const double*)values.data);
+
+    // project the source corners
+    const cv::Point2d corners[4] = { { 0, 0 }, { (double)src.cols, 0 },
+        { (double)src.cols, (double)src.rows }, { 0, (double)src.rows } };
+    cv::Rect box;
+    bool behind = false;
+    double x0 = DBL_MAX, y0 = DBL_MAX, x1 = -DBL_MAX, y1 = -DBL_MAX;
+    for (const auto& corner : corners) {
+        cv::Vec3d q = M * cv::Vec3d(corner.x, corner.y, 1);
+        if (q[2] <= 0) {
+            behind = true;
+            break;
+        }
+        x0 = std::min(x0, q[0] / q[2]);
+        y0 = std::min(y0, q[1] / q[2]);
+        x1 = std::max(x1, q[0] / q[2]);
+        y1 = std::max(y1, q[1] / q[2]);
+    }
+
+    if (behind) {
+        // the quad wraps through infinity: fall back to the full canvas
+        box = image;
+    } else {
+        // one pixel of slack for interpolation at the quad's edges
+        box = cv::Rect(cv::Point(cvFloor(x0) - 1, cvFloor(y0) - 1),
+                  cv::Point(cvCeil(x1) + 2, cvCeil(y1) + 2))
+            & image;
+    }
+    if (box.empty()) {
+        dst.release();
+        return box;
+    }
+
+    // shift the homography so the box's top-left is the patch origin
+    const cv::Matx33d T(1, 0, -box.x, 0, 1, -box.y, 0, 0, 1);
+    cv::warpPerspective(src, dst, cv::Mat(T * M), box.size(), flags);
+    return box;
+}
@@ -0,0 +1,32 @@
+#ifndef KERNEL_H
+#define KERNEL_H
+
+#include <opencv2/core.hpp>
+
+/* separable gaussian kernels:
+ *   amplitude * exp(-(x - cx)^2 / 2sx^2 - (y - cy)^2 / 2sy^2) is the outer
+ *   product of two 1D gaussians, so only width + height exponentials are
+ *   evaluated; the factors can be handed to a separable convolution
+ *   (e.g., Convolver) without building the 2D kernel at all
+ */
+namespace kernel {
+
+enum Normalization {
+    PEAK, // the factors peak at 1 (amplitude at the center)
+    UNIT_SUM // the factors, and so the 2D kernel, sum to 1
+};
+
+// kx: 1 x width, ky: height x 1, both CV_32FC1; amplitude is folded into
+// kx and ignored for UNIT_SUM
+void gaussianFactors(const cv::Size& size, const cv::Point2f& center,
+    const cv::Point2f& sigma, cv::Mat& kx, cv::Mat& ky,
+    const Normalization& normalization = PEAK, const float& amplitude = 1.0f);
+
+// the 2D kernel ky * kx, cached per parameters on the calling thread: the
+// returned data is shared with the cache and must not be written to;
+// build a writable kernel from gaussianFactors instead
+const cv::Mat gaussian(const cv::Size& size, const cv::Point2f& center,
+    const cv::Point2f& sigma, const Normalization& normalization = PEAK,
+    const float& amplitude = 1.0f);
+}
+#endif // KERNEL_H
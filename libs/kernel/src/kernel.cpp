@@ -0,0 +1,66 @@
+#include <cmath>
+#include <map>
+#include <opencv2/core.hpp>
+#include <tuple>
+
+#include "kernel.h"
+
+// kernels kept per thread before the cache starts over
+static const size_t CACHE_SIZE = 16;
+
+static void factor(const int& n, const float& center, const float& sigma,
+    cv::Mat& dst, const bool& unitSum)
+{
+    CV_Assert(n > 0 && sigma > 0);
+    float* p = dst.ptr<float>();
+    const float scale = -0.5f / (sigma * sigma);
+    float sum = 0;
+    for (int i = 0; i < n; i++) {
+        float d = i - center;
+        p[i] = std::exp(scale * d * d);
+        sum += p[i];
+    }
+    if (unitSum) {
+        for (int i = 0; i < n; i++) {
+            p[i] /= sum;
+        }
+    }
+}
+
+void kernel::gaussianFactors(const cv::Size& size, const cv::Point2f& center,
+    const cv::Point2f& sigma, cv::Mat& kx, cv::Mat& ky,
+    const Normalization& normalization, const float& amplitude)
+{
+    const bool unitSum = normalization == UNIT_SUM;
+    kx.create(1, size.width, CV_32FC1);
+    ky.create(size.height, 1, CV_32FC1);
+    factor(size.width, center.x, sigma.x, kx, unitSum);
+    factor(size.height, center.y, sigma.y, ky, unitSum);
+    if (!unitSum && amplitude != 1.0f) {
+        kx *= amplitude;
+    }
+}
+
+const cv::Mat kernel::gaussian(const cv::Size& size, const cv::Point2f& center,
+    const cv::Point2f& sigma, const Normalization& normalization,
+    const float& amplitude)
+{
+    using Key = std::tuple<int, int, float, float, float, float, int, float>;
+    thread_local std::map<Key, cv::Mat> cache;
+
+    Key key(size.width, size.height, center.x, center.y, sigma.x, sigma.y,
+        (int)normalization, amplitude);
+    auto cached = cache.find(key);
+    if (cached != cache.end()) {
+        return cached->second;
+    }
+    if (cache.size() >= CACHE_SIZE) {
+        cache.clear();
+    }
+
+    cv::Mat kx, ky;
+    gaussianFactors(size, center, sigma, kx, ky, normalization, amplitude);
+    cv::Mat k = ky * kx;
+    cache.emplace(key, k);
+    return k;
+}
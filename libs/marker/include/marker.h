@@ -0,0 +1,55 @@
+#ifndef MARKER_H
+#define MARKER_H
+
+#include <opencv2/aruco.hpp>
+#include <opencv2/core.hpp>
+#include <vector>
+
+struct MarkerStats {
+    size_t m_frames;         // frames processed
+    size_t m_fullSearches;   // frames that searched the whole image
+    size_t m_losses;         // tracked markers missed by their window
+    size_t m_reacquisitions; // ... of which the full search found again
+    double m_lastMs;         // latency of the last detect()
+    double m_meanMs;         // mean latency
+
+    double reacquisitionRate() const
+    {
+        return m_losses == 0 ? 1.0 : (double)m_reacquisitions / m_losses;
+    }
+};
+
+/* ROI-tracked aruco detection:
+ *   markers found on the previous frame are searched for in padded
+ *   windows around their last corners, in parallel; the whole image is
+ *   searched only every period frames, when nothing is tracked, or when
+ *   a tracked marker drops out of its window
+ */
+class MarkerTracker {
+public:
+    // padding: window margin as a fraction of the marker's size
+    explicit MarkerTracker(const cv::Ptr<cv::aruco::Dictionary>& dictionary,
+        const int& period = 30, const double& padding = 0.5);
+
+    // frame: BGRA, BGR or grayscale
+    void detect(const cv::Mat& frame,
+        std::vector<std::vector<cv::Point2f>>& corners, std::vector<int>& ids);
+
+    MarkerStats stats() const { return m_stats; }
+
+private:
+    void search(const cv::Mat& gray,
+        std::vector<std::vector<cv::Point2f>>& corners,
+        std::vector<int>& ids) const;
+
+    cv::Ptr<cv::aruco::Dictionary> m_dictionary;
+    cv::Ptr<cv::aruco::DetectorParameters> m_parameters;
+    int m_period;
+    double m_padding;
+
+    cv::Mat m_gray;
+    std::vector<std::vector<cv::Point2f>> m_corners;
+    std::vector<int> m_ids;
+    MarkerStats m_stats;
+};
+#endif // MARKER_H
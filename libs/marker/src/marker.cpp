@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <opencv2/imgproc.hpp>
+
+#include "marker.h"
+
+// smallest window margin (px), so small markers keep a quiet zone
+static const int MIN_PADDING = 8;
+
+MarkerTracker::MarkerTracker(const cv::Ptr<cv::aruco::Dictionary>& dictionary,
+    const int& period, const double& padding)
+    : m_dictionary(dictionary)
+    , m_parameters(cv::aruco::DetectorParameters::create())
+    , m_period(std::max(1, period))
+    , m_padding(padding)
+    , m_stats { 0, 0, 0, 0, 0.0, 0.0 }
+{
+}
+
+void MarkerTracker::search(const cv::Mat& gray,
+    std::vector<std::vector<cv::Point2f>>& corners,
+    std::vector<int>& ids) const
+{
+    cv::aruco::detectMarkers(gray, m_dictionary, corners, ids, m_parameters);
+}
+
+void MarkerTracker::detect(const cv::Mat& frame,
+    std::vector<std::vector<cv::Point2f>>& corners, std::vector<int>& ids)
+{
+    int64 start = cv::getTickCount();
+
+    // grayscale straight from the sensor format
+    switch (frame.channels()) {
+    case 4:
+        cv::cvtColor(frame, m_gray, cv::COLOR_BGRA2GRAY);
+        break;
+    case 3:
+        cv::cvtColor(frame, m_gray, cv::COLOR_BGR2GRAY);
+        break;
+    default:
+        m_gray = frame;
+    }
+    const cv::Rect image(cv::Point(0, 0), m_gray.size());
+
+    corners.clear();
+    ids.clear();
+    bool full = m_ids.empty() || m_stats.m_frames % m_period == 0;
+    std::vector<int> lost;
+
+    if (!full) {
+        // one padded window per tracked marker, searched in parallel
+        const size_t n = m_ids.size();
+        std::vector<cv::Rect> windows(n);
+        for (size_t i = 0; i < n; i++) {
+            cv::Rect box = cv::boundingRect(m_corners[i]);
+            int pad = std::max(MIN_PADDING,
+                (int)(m_padding * std::max(box.width, box.height)));
+            windows[i] = cv::Rect(box.x - pad, box.y - pad,
+                             box.width + 2 * pad, box.height + 2 * pad)
+                & image;
+        }
+        std::vector<std::vector<std::vector<cv::Point2f>>> found(n);
+        std::vector<std::vector<int>> foundIds(n);
+        cv::parallel_for_(cv::Range(0, (int)n), [&](const cv::Range& range) {
+            for (int i = range.start; i < range.end; i++) {
+                if (!windows[i].empty()) {
+                    search(m_gray(windows[i]), found[i], foundIds[i]);
+                }
+            }
+        });
+
+        // keep each window's own marker, back in image coordinates
+        for (size_t i = 0; i < n; i++) {
+            auto match = std::find(
+                foundIds[i].begin(), foundIds[i].end(), m_ids[i]);
+            if (match == foundIds[i].end()) {
+                lost.push_back(m_ids[i]);
+                full = true;
+                continue;
+            }
+            std::vector<cv::Point2f> marker
+                = found[i][match - foundIds[i].begin()];
+            for (auto& corner : marker) {
+                corner += cv::Point2f(windows[i].tl());
+            }
+            corners.push_back(marker);
+            ids.push_back(m_ids[i]);
+        }
+    }
+
+    if (full) {
+        search(m_gray, corners, ids);
+        m_stats.m_fullSearches++;
+
+        // lost markers the full search found again
+        m_stats.m_losses += lost.size();
+        for (const auto& id : lost) {
+            if (std::find(ids.begin(), ids.end(), id) != ids.end()) {
+                m_stats.m_reacquisitions++;
+            }
+        }
+    }
+    m_corners = corners;
+    m_ids = ids;
+
+    double ms = (double)(cv::getTickCount() - start) * 1000.0
+        / cv::getTickFrequency();
+    m_stats.m_frames++;
+    m_stats.m_lastMs = ms;
+    m_stats.m_meanMs += (ms - m_stats.m_meanMs) / (double)m_stats.m_frames;
+}
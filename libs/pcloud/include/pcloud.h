@@ -6,12 +6,28 @@
 #include <vector>
 
 namespace pcloud {
+
+// ply encodings: BINARY writes fixed-size little-endian vertex records
+// (short x, y, z; uchar red, green, blue), i.e., 9 bytes per point
+enum Format { ASCII, BINARY };
+
+// number of points build() would keep
+size_t count(
+    const int& w, const int& h, const int16_t* pCloudData, const uint8_t* bgra);
+
 std::vector<Point> build(
     const int& w, const int& h, const int16_t* pCloudData, const uint8_t* bgra);
 
+// same as above, compacting into a caller-owned cloud whose capacity is
+// reused across frames
+void build(const int& w, const int& h, const int16_t* pCloudData,
+    const uint8_t* bgra, std::vector<Point>& pCloud);
+
 void write(const int& w, const int& h, const int16_t* pCloudData,
-    const uint8_t* rgbData, const std::string& file);
+    const uint8_t* rgbData, const std::string& file,
+    const Format& format = ASCII);
 
-void write(const std::vector<Point>& pCloud, const std::string& file);
+void write(const std::vector<Point>& pCloud, const std::string& file,
+    const Format& format = ASCII);
 }
 #endif // POINT_CLOUD_H
@@ -1,94 +1,249 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
-#include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "pcloud.h"
 
-#define PLY_HEADER                                                             \
-    std::ofstream ofs(file);                                                   \
-    ofs << "ply" << std::endl;                                                 \
-    ofs << "format ascii 1.0" << std::endl;                                    \
-    ofs << "element vertex"                                                    \
-        << " " << pCloud.size() << std::endl;                                  \
-    ofs << "property float x" << std::endl;                                    \
-    ofs << "property float y" << std::endl;                                    \
-    ofs << "property float z" << std::endl;                                    \
-    ofs << "property uchar red" << std::endl;                                  \
-    ofs << "property uchar green" << std::endl;                                \
-    ofs << "property uchar blue" << std::endl;                                 \
-    ofs << "end_header" << std::endl;                                          \
-    ofs.close()
+// binary vertex record: 3 x int16 (little-endian) + 3 x uint8
+static const size_t VERTEX_BYTES = 9;
 
-std::vector<Point> pcloud::build(
-    const int& w, const int& h, const int16_t* pCloudData, const uint8_t* bgra)
+// longest ascii vertex record: "-32768 -32768 -32768 255 255 255\n"
+static const size_t ASCII_BYTES = 34;
+
+// bytes buffered before each write to disk
+static const size_t BLOCK_BYTES = 16 * 4096;
+
+// smallest number of image rows worth handing to a build thread
+static const int MIN_BLOCK_ROWS = 32;
+
+static void header(
+    std::ofstream& ofs, const size_t& size, const pcloud::Format& format)
 {
-    std::vector<Point> pCloud;
-    for (int i = 0; i < w * h; i++) {
-        Point point {};
-        point.m_xyz[0] = pCloudData[3 * i + 0];
-        point.m_xyz[1] = pCloudData[3 * i + 1];
-        point.m_xyz[2] = pCloudData[3 * i + 2];
-        if (point.m_xyz[2] == 0) {
-            continue;
+    ofs << "ply" << std::endl;
+    if (format == pcloud::BINARY) {
+        ofs << "format binary_little_endian 1.0" << std::endl;
+    } else {
+        ofs << "format ascii 1.0" << std::endl;
+    }
+    ofs << "element vertex"
+        << " " << size << std::endl;
+    if (format == pcloud::BINARY) {
+        ofs << "property short x" << std::endl;
+        ofs << "property short y" << std::endl;
+        ofs << "property short z" << std::endl;
+    } else {
+        ofs << "property float x" << std::endl;
+        ofs << "property float y" << std::endl;
+        ofs << "property float z" << std::endl;
+    }
+    ofs << "property uchar red" << std::endl;
+    ofs << "property uchar green" << std::endl;
+    ofs << "property uchar blue" << std::endl;
+    ofs << "end_header" << std::endl;
+}
+
+// a point is valid iff it has depth and a non-zero bgra word
+static inline int valid(const int16_t* xyz, const uint8_t* bgra)
+{
+    uint32_t color;
+    std::memcpy(&color, bgra, sizeof(color));
+    return (int)(xyz[2] != 0) & (int)(color != 0);
+}
+
+// branch-free count, written so the compares auto-vectorize
+static size_t countRange(const int16_t* pCloudData, const uint8_t* bgra,
+    const int& begin, const int& end)
+{
+    size_t n = 0;
+    for (int i = begin; i < end; i++) {
+        n += valid(&pCloudData[3 * i], &bgra[4 * i]);
+    }
+    return n;
+}
+
+static Point point(const int16_t* pCloudData, const uint8_t* bgra, const int& i)
+{
+    Point point {};
+    point.m_xyz[0] = pCloudData[3 * i + 0];
+    point.m_xyz[1] = pCloudData[3 * i + 1];
+    point.m_xyz[2] = pCloudData[3 * i + 2];
+
+    uint8_t r = bgra[4 * i + 2];
+    uint8_t g = bgra[4 * i + 1];
+    uint8_t b = bgra[4 * i + 0];
+    uint8_t a = bgra[4 * i + 3];
+    uint8_t rgba[4] = { r, g, b, a };
+    point.setRGBA(rgba);
+    return point;
+}
+
+static void compact(const int16_t* pCloudData, const uint8_t* bgra,
+    const int& begin, const int& end, Point* dst)
+{
+    for (int i = begin; i < end; i++) {
+        if (valid(&pCloudData[3 * i], &bgra[4 * i])) {
+            *dst++ = point(pCloudData, bgra, i);
         }
-        uint8_t r = bgra[4 * i + 2];
-        uint8_t g = bgra[4 * i + 1];
-        uint8_t b = bgra[4 * i + 0];
-        uint8_t a = bgra[4 * i + 3];
-        uint8_t rgba[4] = { r, g, b, a };
-        point.setRGBA(rgba);
-
-        if (point.m_rgba[0] == 0 && point.m_rgba[1] == 0 && point.m_rgba[2] == 0
-            && point.m_rgba[3] == 0) {
-            continue;
+    }
+}
+
+// serialize one vertex, returns the number of bytes used; binary
+// records are encoded byte-wise so the file is little-endian on any host
+static size_t encode(
+    char* record, const Point& point, const pcloud::Format& format)
+{
+    const int16_t xyz[3] = { (int16_t)point.m_xyz[0], (int16_t)point.m_xyz[1],
+        (int16_t)point.m_xyz[2] };
+
+    // k4a color image is in fact BGR (not RGB)
+    const uint8_t r = point.m_rgba[2];
+    const uint8_t g = point.m_rgba[1];
+    const uint8_t b = point.m_rgba[0];
+
+    if (format == pcloud::ASCII) {
+        return (size_t)std::snprintf(record, ASCII_BYTES, "%d %d %d %d %d %d\n",
+            xyz[0], xyz[1], xyz[2], r, g, b);
+    }
+    for (int i = 0; i < 3; i++) {
+        auto value = (uint16_t)xyz[i];
+        record[2 * i + 0] = (char)(value & 0xff);
+        record[2 * i + 1] = (char)(value >> 8);
+    }
+    record[6] = (char)r;
+    record[7] = (char)g;
+    record[8] = (char)b;
+    return VERTEX_BYTES;
+}
+
+namespace {
+// fixed-size staging block between the vertex encoder and the file
+class Block {
+public:
+    Block(std::ofstream& ofs, const pcloud::Format& format)
+        : m_ofs(ofs)
+        , m_format(format)
+        , m_size(0)
+    {
+    }
+
+    ~Block() { flush(); }
+
+    void push(const Point& point)
+    {
+        if (m_size + ASCII_BYTES > BLOCK_BYTES) {
+            flush();
         }
-        pCloud.push_back(point);
+        m_size += encode(&m_data[m_size], point, m_format);
     }
+
+    void flush()
+    {
+        m_ofs.write(m_data, (std::streamsize)m_size);
+        m_size = 0;
+    }
+
+private:
+    std::ofstream& m_ofs;
+    pcloud::Format m_format;
+    size_t m_size;
+    char m_data[BLOCK_BYTES];
+};
+}
+
+size_t pcloud::count(
+    const int& w, const int& h, const int16_t* pCloudData, const uint8_t* bgra)
+{
+    return countRange(pCloudData, bgra, 0, w * h);
+}
+
+std::vector<Point> pcloud::build(
+    const int& w, const int& h, const int16_t* pCloudData, const uint8_t* bgra)
+{
+    std::vector<Point> pCloud;
+    build(w, h, pCloudData, bgra, pCloud);
     return pCloud;
 }
 
-void pcloud::write(const int& w, const int& h, const int16_t* pCloudData,
-    const uint8_t* rgbData, const std::string& file)
+void pcloud::build(const int& w, const int& h, const int16_t* pCloudData,
+    const uint8_t* bgra, std::vector<Point>& pCloud)
 {
-    std::vector<Point> pCloud = build(w, h, pCloudData, rgbData);
+    // split image into row blocks, one per core
+    int cores = (int)std::max(1u, std::thread::hardware_concurrency());
+    int blocks = std::max(1, std::min(cores, h / MIN_BLOCK_ROWS));
+    int rows = (h + blocks - 1) / blocks;
 
-    PLY_HEADER;
-    std::stringstream ss;
-    for (auto& point : pCloud) {
-        int16_t x = point.m_xyz[0];
-        int16_t y = point.m_xyz[1];
-        int16_t z = point.m_xyz[2];
+    std::vector<int> begin(blocks);
+    std::vector<int> end(blocks);
+    std::vector<size_t> offset(blocks + 1, 0);
+    for (int k = 0; k < blocks; k++) {
+        begin[k] = std::min(h, k * rows) * w;
+        end[k] = std::min(h, (k + 1) * rows) * w;
+    }
+
+    // pass 1: count valid points per block
+    std::vector<std::thread> workers;
+    for (int k = 1; k < blocks; k++) {
+        workers.emplace_back([&, k]() {
+            offset[k + 1] = countRange(pCloudData, bgra, begin[k], end[k]);
+        });
+    }
+    offset[1] = countRange(pCloudData, bgra, begin[0], end[0]);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
 
-        // k4a color image is in fact BGR (not RGB)
-        auto r = (float)point.m_rgba[2];
-        auto g = (float)point.m_rgba[1];
-        auto b = (float)point.m_rgba[0];
+    // exclusive scan gives each block its slice of the output, which
+    // preserves the serial (row-major) point order
+    for (int k = 0; k < blocks; k++) {
+        offset[k + 1] += offset[k];
+    }
+
+    pCloud.resize(offset[blocks]);
+    if (pCloud.empty()) {
+        return;
+    }
 
-        ss << x << " " << y << " " << z << " ";
-        ss << r << " " << g << " " << b << std::endl;
+    // pass 2: compact each block into its slice
+    for (int k = 1; k < blocks; k++) {
+        workers.emplace_back([&, k]() {
+            compact(pCloudData, bgra, begin[k], end[k], &pCloud[0] + offset[k]);
+        });
+    }
+    compact(pCloudData, bgra, begin[0], end[0], &pCloud[0]);
+    for (auto& worker : workers) {
+        worker.join();
     }
-    std::ofstream ofs_text(file, std::ios::out | std::ios::app);
-    ofs_text.write(ss.str().c_str(), (std::streamsize)ss.str().length());
 }
 
-void pcloud::write(const std::vector<Point>& pCloud, const std::string& file)
+void pcloud::write(const int& w, const int& h, const int16_t* pCloudData,
+    const uint8_t* rgbData, const std::string& file, const Format& format)
 {
-    PLY_HEADER;
-    std::stringstream ss;
-    for (auto& point : pCloud) {
-        int16_t x = point.m_xyz[0];
-        int16_t y = point.m_xyz[1];
-        int16_t z = point.m_xyz[2];
+    // cheap first pass sizes the header, the second streams vertices
+    // straight from the k4a buffers without materializing the cloud
+    size_t size = count(w, h, pCloudData, rgbData);
 
-        // k4a color image is in fact BGR (not RGB)
-        auto r = (float)point.m_rgba[2];
-        auto g = (float)point.m_rgba[1];
-        auto b = (float)point.m_rgba[0];
+    std::ofstream ofs(file, std::ios::out | std::ios::binary);
+    header(ofs, size, format);
+    Block block(ofs, format);
+    for (int i = 0; i < w * h; i++) {
+        if (valid(&pCloudData[3 * i], &rgbData[4 * i])) {
+            block.push(point(pCloudData, rgbData, i));
+        }
+    }
+}
 
-        ss << x << " " << y << " " << z << " ";
-        ss << r << " " << g << " " << b << std::endl;
+void pcloud::write(const std::vector<Point>& pCloud, const std::string& file,
+    const Format& format)
+{
+    std::ofstream ofs(file, std::ios::out | std::ios::binary);
+    header(ofs, pCloud.size(), format);
+    Block block(ofs, format);
+    for (auto& point : pCloud) {
+        block.push(point);
     }
-    std::ofstream ofs_text(file, std::ios::out | std::ios::app);
-    ofs_text.write(ss.str().c_str(), (std::streamsize)ss.str().length());
 }
@@ -0,0 +1,78 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <atomic>
+#include <functional>
+#include <thread>
+
+#include "ring.h"
+
+struct PipelineStats {
+    size_t m_captured; // frames grabbed by the capture thread
+    size_t m_dropped;  // frames evicted by the backpressure policy
+    size_t m_depth;    // frames waiting to be consumed
+};
+
+/* asynchronous capture:
+ *   a dedicated thread grabs frames and pushes them into a bounded ring,
+ *   so slow consumers (processing, display) never stall the sensor
+ */
+template <typename T> class Pipeline {
+public:
+    Pipeline(std::function<T()> grab, const size_t& capacity,
+        const Backpressure& policy)
+        : m_grab(std::move(grab))
+        , m_ring(capacity, policy)
+        , m_running(false)
+        , m_captured(0)
+    {
+    }
+
+    ~Pipeline() { stop(); }
+
+    Pipeline(const Pipeline&) = delete;
+    Pipeline& operator=(const Pipeline&) = delete;
+
+    // may follow stop(): the ring closed by stop() is reopened
+    void start()
+    {
+        if (m_thread.joinable()) {
+            return; // already running
+        }
+        m_ring.open();
+        m_running = true;
+        m_thread = std::thread([this]() {
+            while (m_running) {
+                m_ring.push(m_grab());
+                m_captured++;
+            }
+        });
+    }
+
+    void stop()
+    {
+        m_running = false;
+        m_ring.close();
+        if (m_thread.joinable()) {
+            m_thread.join();
+        }
+    }
+
+    bool pop(T& frame, const int& timeoutMs)
+    {
+        return m_ring.pop(frame, timeoutMs);
+    }
+
+    PipelineStats stats() const
+    {
+        return { m_captured.load(), m_ring.dropped(), m_ring.depth() };
+    }
+
+private:
+    std::function<T()> m_grab;
+    Ring<T> m_ring;
+    std::atomic<bool> m_running;
+    std::atomic<size_t> m_captured;
+    std::thread m_thread;
+};
+#endif // PIPELINE_H
@@ -0,0 +1,201 @@
+#ifndef RING_H
+#define RING_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/* bounded ring of frames:
+ *   push/pop are lock-free (sequence-numbered slots); the mutex and
+ *   condition variable are only used to park threads that must wait
+ *
+ *   DROP_OLDEST : a full ring evicts its oldest frame
+ *   BLOCK       : a full ring makes the producer wait for space
+ *   LATEST_ONLY : the ring holds just the newest frame
+ */
+enum Backpressure { DROP_OLDEST, BLOCK, LATEST_ONLY };
+
+template <typename T> class Ring {
+public:
+    Ring(const size_t& capacity, const Backpressure& policy)
+        : m_policy(policy)
+        , m_slots(policy == LATEST_ONLY ? 2 : roundUp(capacity))
+        , m_mask(m_slots.size() - 1)
+        , m_head(0)
+        , m_tail(0)
+        , m_dropped(0)
+        , m_closed(false)
+    {
+        for (size_t i = 0; i < m_slots.size(); i++) {
+            m_slots[i].m_seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // single producer
+    void push(T frame)
+    {
+        if (m_policy == LATEST_ONLY) {
+            T stale;
+            while (tryPop(stale)) {
+                m_dropped++;
+            }
+        }
+        while (!tryPush(frame)) {
+            if (m_policy == BLOCK) {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_space.wait(lock, [&]() { return !full() || m_closed; });
+                if (m_closed) {
+                    return;
+                }
+            } else {
+                T oldest;
+                if (tryPop(oldest)) {
+                    m_dropped++;
+                }
+            }
+        }
+        notify(m_ready);
+    }
+
+    // any number of consumers; false on timeout or once closed and empty
+    bool pop(T& frame, const int& timeoutMs)
+    {
+        bool popped = tryPop(frame);
+        if (!popped) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_ready.wait_for(lock, std::chrono::milliseconds(timeoutMs), [&]() {
+                popped = tryPop(frame);
+                return popped || m_closed;
+            });
+        }
+        if (popped) {
+            notify(m_space);
+        }
+        return popped;
+    }
+
+    // wake every waiting thread, e.g., on shutdown
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_closed = true;
+        }
+        m_ready.notify_all();
+        m_space.notify_all();
+    }
+
+    // undo close(), e.g., when a stopped pipeline is started again
+    void open()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closed = false;
+    }
+
+    size_t depth() const
+    {
+        size_t tail = m_tail.load(std::memory_order_acquire);
+        size_t head = m_head.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+
+    size_t capacity() const
+    {
+        return m_policy == LATEST_ONLY ? 1 : m_slots.size();
+    }
+
+    size_t dropped() const { return m_dropped.load(); }
+
+private:
+    struct Slot {
+        std::atomic<size_t> m_seq;
+        T m_frame;
+    };
+
+    // sequence-numbered slots need a power of two, and at least two
+    static size_t roundUp(const size_t& n)
+    {
+        size_t size = 2;
+        while (size < n) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    bool full() const { return depth() >= m_slots.size(); }
+
+    bool tryPush(T& frame)
+    {
+        size_t pos = m_tail.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot = &m_slots[pos & m_mask];
+            size_t seq = slot->m_seq.load(std::memory_order_acquire);
+            auto diff = (std::ptrdiff_t)seq - (std::ptrdiff_t)pos;
+            if (diff == 0) {
+                if (m_tail.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // full
+            } else {
+                pos = m_tail.load(std::memory_order_relaxed);
+            }
+        }
+        slot->m_frame = std::move(frame);
+        slot->m_seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(T& frame)
+    {
+        size_t pos = m_head.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot = &m_slots[pos & m_mask];
+            size_t seq = slot->m_seq.load(std::memory_order_acquire);
+            auto diff = (std::ptrdiff_t)seq - (std::ptrdiff_t)(pos + 1);
+            if (diff == 0) {
+                if (m_head.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // empty
+            } else {
+                pos = m_head.load(std::memory_order_relaxed);
+            }
+        }
+        frame = std::move(slot->m_frame);
+        slot->m_frame = T();
+        slot->m_seq.store(pos + m_mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    // taking the mutex orders the notification after a waiter's check
+    void notify(std::condition_variable& condition)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+        }
+        condition.notify_all();
+    }
+
+    Backpressure m_policy;
+    std::vector<Slot> m_slots;
+    size_t m_mask;
+    std::atomic<size_t> m_head;
+    std::atomic<size_t> m_tail;
+    std::atomic<size_t> m_dropped;
+
+    std::mutex m_mutex;
+    std::condition_variable m_ready;
+    std::condition_variable m_space;
+    bool m_closed;
+};
+#endif // RING_H
@@ -0,0 +1,63 @@
+#ifndef PIXEL_H
+#define PIXEL_H
+
+#include <opencv2/core.hpp>
+
+/* typed per-pixel kernels:
+ *   a lambda over one pixel, i.e., CN channels of type T fixed at compile
+ *   time, applied through plain row pointers with rows split across
+ *   threads. the inner loop is a counted loop over a contiguous row with
+ *   the lambda inlined, which compilers auto-vectorize; no at<>() bounds
+ *   or type checks per pixel
+ */
+namespace pixel {
+
+// rows handed to one parallel_for_ stripe
+const int STRIPE_ROWS = 16;
+
+template <typename T, int CN> void check(const cv::Mat& mat)
+{
+    CV_Assert(mat.depth() == cv::DataType<T>::depth && mat.channels() == CN);
+}
+
+// f(T* px) for every pixel of img, in place
+template <typename T, int CN, typename F> void apply(cv::Mat& img, F f)
+{
+    check<T, CN>(img);
+    const int cols = img.cols;
+    cv::parallel_for_(
+        cv::Range(0, img.rows),
+        [&](const cv::Range& rows) {
+            for (int y = rows.start; y < rows.end; y++) {
+                T* p = img.ptr<T>(y);
+                for (int x = 0; x < cols; x++) {
+                    f(p + x * CN);
+                }
+            }
+        },
+        (double)img.rows / STRIPE_ROWS);
+}
+
+// f(const T* in, T* out) for every pixel; dst takes src's size and type,
+// and may alias src
+template <typename T, int CN, typename F>
+void transform(const cv::Mat& src, cv::Mat& dst, F f)
+{
+    check<T, CN>(src);
+    dst.create(src.size(), src.type());
+    const int cols = src.cols;
+    cv::parallel_for_(
+        cv::Range(0, src.rows),
+        [&](const cv::Range& rows) {
+            for (int y = rows.start; y < rows.end; y++) {
+                const T* in = src.ptr<T>(y);
+                T* out = dst.ptr<T>(y);
+                for (int x = 0; x < cols; x++) {
+                    f(in + x * CN, out + x * CN);
+                }
+            }
+        },
+        (double)src.rows / STRIPE_ROWS);
+}
+}
+#endif // PIXEL_H
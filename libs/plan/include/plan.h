@@ -0,0 +1,67 @@
+#ifndef PLAN_H
+#define PLAN_H
+
+#include <memory>
+
+#include "kinect.h"
+
+/* capture plans:
+ *   name the images a consumer needs, and only the k4a work those images
+ *   depend on is done per frame
+ *
+ *   COLOR          : Kinect::m_img
+ *   DEPTH          : Kinect::m_depth
+ *   POINT_CLOUD    : pcl() (needs DEPTH)
+ *   COLOR_TO_DEPTH : c2d() (needs COLOR and DEPTH)
+ *
+ *   given the device calibration, the plan owns a k4a transformation and
+ *   computes each transformed image on its own, into images it owns until
+ *   release(); without it, Kinect::transform computes both, so asking for
+ *   either gets both. Frames built from them keep their own reference
+ */
+enum CaptureImage {
+    COLOR = 1 << 0,
+    DEPTH = 1 << 1,
+    POINT_CLOUD = 1 << 2,
+    COLOR_TO_DEPTH = 1 << 3
+};
+
+class CapturePlan {
+public:
+    CapturePlan(std::shared_ptr<Kinect>& sptr_kinect, const int& images);
+
+    // calibration: of the device sptr_kinect opened
+    CapturePlan(std::shared_ptr<Kinect>& sptr_kinect, const int& images,
+        const k4a_calibration_t& calibration);
+
+    ~CapturePlan();
+
+    CapturePlan(const CapturePlan&) = delete;
+    CapturePlan& operator=(const CapturePlan&) = delete;
+
+    // grab a new capture and materialize the planned images
+    void capture();
+
+    // materialize more images from the current capture, on demand
+    void require(const int& images);
+
+    // hand the capture and its images back to the sensor
+    void release();
+
+    // images materialized from the current capture
+    int images() const { return m_done; }
+
+    // transformed images of the current capture (nullptr until required)
+    k4a_image_t pcl() const { return m_pcl; }
+    k4a_image_t c2d() const { return m_c2d; }
+
+private:
+    std::shared_ptr<Kinect> m_kinect;
+    k4a_transformation_t m_transform; // nullptr: use Kinect::transform
+    k4a_image_t m_pcl;
+    k4a_image_t m_c2d;
+    int m_images;
+    int m_done;
+    bool m_captured;
+};
+#endif // PLAN_H
@@ -0,0 +1,173 @@
+#include <stdexcept>
+
+#include "plan.h"
+
+// k4a work, in the order it has to run
+enum Stage {
+    STAGE_COLOR = 1 << 0,
+    STAGE_DEPTH = 1 << 1,
+    STAGE_PCL = 1 << 2,
+    STAGE_C2D = 1 << 3
+};
+
+// shared: both transformed images come from one Kinect::transform call
+static int stages(const int& images, const bool& shared)
+{
+    int work = 0;
+    if (images & COLOR) {
+        work |= STAGE_COLOR;
+    }
+    if (images & DEPTH) {
+        work |= STAGE_DEPTH;
+    }
+    if (images & POINT_CLOUD) {
+        work |= STAGE_DEPTH | STAGE_PCL;
+    }
+    if (images & COLOR_TO_DEPTH) {
+        work |= STAGE_COLOR | STAGE_DEPTH | STAGE_C2D;
+    }
+    if (shared && (work & (STAGE_PCL | STAGE_C2D))) {
+        work |= STAGE_COLOR | STAGE_DEPTH | STAGE_PCL | STAGE_C2D;
+    }
+    return work;
+}
+
+static int materialized(const int& work)
+{
+    int images = 0;
+    if (work & STAGE_COLOR) {
+        images |= COLOR;
+    }
+    if (work & STAGE_DEPTH) {
+        images |= DEPTH;
+    }
+    if (work & STAGE_PCL) {
+        images |= POINT_CLOUD;
+    }
+    if (work & STAGE_C2D) {
+        images |= COLOR_TO_DEPTH;
+    }
+    return images;
+}
+
+// an image at depth resolution for a transformation to write into
+static k4a_image_t depthSized(
+    k4a_image_t depth, const k4a_image_format_t& format, const int& bpp)
+{
+    int w = k4a_image_get_width_pixels(depth);
+    int h = k4a_image_get_height_pixels(depth);
+    k4a_image_t image = nullptr;
+    if (k4a_image_create(format, w, h, w * bpp, &image)
+        != K4A_RESULT_SUCCEEDED) {
+        throw std::runtime_error("capture plan: failed to create image");
+    }
+    return image;
+}
+
+CapturePlan::CapturePlan(
+    std::shared_ptr<Kinect>& sptr_kinect, const int& images)
+    : m_kinect(sptr_kinect)
+    , m_transform(nullptr)
+    , m_pcl(nullptr)
+    , m_c2d(nullptr)
+    , m_images(images)
+    , m_done(0)
+    , m_captured(false)
+{
+}
+
+CapturePlan::CapturePlan(std::shared_ptr<Kinect>& sptr_kinect,
+    const int& images, const k4a_calibration_t& calibration)
+    : CapturePlan(sptr_kinect, images)
+{
+    m_transform = k4a_transformation_create(&calibration);
+    if (m_transform == nullptr) {
+        throw std::runtime_error("capture plan: failed to create transform");
+    }
+}
+
+CapturePlan::~CapturePlan()
+{
+    release();
+    if (m_transform != nullptr) {
+        k4a_transformation_destroy(m_transform);
+    }
+}
+
+void CapturePlan::capture()
+{
+    release();
+    m_kinect->capture();
+    m_captured = true;
+    require(m_images);
+}
+
+void CapturePlan::require(const int& images)
+{
+    if (!m_captured) {
+        capture();
+    }
+    const bool shared = m_transform == nullptr;
+    int done = stages(m_done, shared);
+    int todo = stages(images, shared) & ~done;
+    if (todo == 0) {
+        return;
+    }
+    if (todo & STAGE_DEPTH) {
+        m_kinect->depthCapture();
+    }
+    if (todo & STAGE_COLOR) {
+        m_kinect->imgCapture();
+    }
+
+    if (shared) {
+        // stages() planned both transformed images together
+        if (todo & STAGE_PCL) {
+            m_kinect->pclCapture();
+            m_kinect->c2dCapture();
+            m_kinect->transform(RGB_TO_DEPTH);
+            m_pcl = m_kinect->m_pcl;
+            m_c2d = m_kinect->m_c2d;
+        }
+        m_done = materialized(done | todo);
+        return;
+    }
+
+    // one transformation per requested image
+    if (todo & STAGE_PCL) {
+        m_pcl = depthSized(
+            m_kinect->m_depth, K4A_IMAGE_FORMAT_CUSTOM, 3 * sizeof(int16_t));
+        if (k4a_transformation_depth_image_to_point_cloud(m_transform,
+                m_kinect->m_depth, K4A_CALIBRATION_TYPE_DEPTH, m_pcl)
+            != K4A_RESULT_SUCCEEDED) {
+            throw std::runtime_error("capture plan: point cloud failed");
+        }
+    }
+    if (todo & STAGE_C2D) {
+        m_c2d = depthSized(m_kinect->m_depth, K4A_IMAGE_FORMAT_COLOR_BGRA32, 4);
+        if (k4a_transformation_color_image_to_depth_camera(m_transform,
+                m_kinect->m_depth, m_kinect->m_img, m_c2d)
+            != K4A_RESULT_SUCCEEDED) {
+            throw std::runtime_error("capture plan: color-to-depth failed");
+        }
+    }
+    m_done = materialized(done | todo);
+}
+
+void CapturePlan::release()
+{
+    if (!m_captured) {
+        return;
+    }
+    // Kinect::releaseK4aImages releases its own transformed images
+    for (k4a_image_t* image : { &m_pcl, &m_c2d }) {
+        if (*image != nullptr && m_transform != nullptr) {
+            k4a_image_release(*image);
+        }
+        *image = nullptr;
+    }
+    m_kinect->releaseK4aCapture();
+    m_kinect->releaseK4aImages();
+    m_done = 0;
+    m_captured = false;
+}
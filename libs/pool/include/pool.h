@@ -0,0 +1,31 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <opencv2/core.hpp>
+#include <vector>
+
+/* per-frame workspace:
+ *   acquire() hands out buffers keyed by size and type, reset() returns
+ *   all of them at the start of the next frame; after the first frame a
+ *   pipeline drawing its temporaries from a pool allocates nothing
+ */
+class MatPool {
+public:
+    MatPool();
+
+    cv::Mat acquire(const cv::Size& size, const int& type);
+
+    void reset();
+
+    // number of buffers the pool has had to allocate so far
+    size_t allocations() const { return m_allocations; }
+
+private:
+    struct Buffer {
+        cv::Mat m_mat;
+        bool m_used;
+    };
+    std::vector<Buffer> m_buffers;
+    size_t m_allocations;
+};
+#endif // POOL_H
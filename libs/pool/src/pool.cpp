@@ -0,0 +1,27 @@
+#include "pool.h"
+
+MatPool::MatPool()
+    : m_allocations(0)
+{
+}
+
+cv::Mat MatPool::acquire(const cv::Size& size, const int& type)
+{
+    for (auto& buffer : m_buffers) {
+        if (!buffer.m_used && buffer.m_mat.size() == size
+            && buffer.m_mat.type() == type) {
+            buffer.m_used = true;
+            return buffer.m_mat;
+        }
+    }
+    m_buffers.push_back({ cv::Mat(size, type), true });
+    m_allocations++;
+    return m_buffers.back().m_mat;
+}
+
+void MatPool::reset()
+{
+    for (auto& buffer : m_buffers) {
+        buffer.m_used = false;
+    }
+}
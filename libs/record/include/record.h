@@ -0,0 +1,73 @@
+#ifndef RECORD_H
+#define RECORD_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/* RGB-D recordings:
+ *   <file>     : 64 byte header, then one chunk per frame holding the raw
+ *                int16 xyz point-cloud image followed by the bgra image
+ *                (both at depth resolution), padded to 64 bytes
+ *   <file>.idx : one fixed-size RecordIndex per chunk
+ *
+ * both files are append-only, so a recording interrupted mid-session
+ * stays readable up to its last indexed frame
+ */
+
+struct RecordIndex {
+    uint64_t m_timestamp; // device timestamp (usec)
+    uint64_t m_offset;    // chunk offset in the data file
+    uint32_t m_width;
+    uint32_t m_height;
+    uint32_t m_points; // number of valid points (see pcloud::count)
+    uint32_t m_reserved;
+};
+
+// zero-copy view of one recorded frame, valid while its Recording lives
+struct RecordView {
+    uint64_t m_timestamp;
+    int m_width;
+    int m_height;
+    uint32_t m_points;
+    const int16_t* m_pCloudData;
+    const uint8_t* m_bgra;
+};
+
+class Recorder {
+public:
+    explicit Recorder(const std::string& file);
+
+    void append(const uint64_t& timestamp, const int& w, const int& h,
+        const int16_t* pCloudData, const uint8_t* bgra);
+
+    size_t size() const { return m_frames; }
+
+private:
+    std::ofstream m_data;
+    std::ofstream m_index;
+    uint64_t m_offset;
+    size_t m_frames;
+};
+
+class Recording {
+public:
+    explicit Recording(const std::string& file);
+    ~Recording();
+
+    Recording(const Recording&) = delete;
+    Recording& operator=(const Recording&) = delete;
+
+    size_t size() const { return m_index.size(); }
+
+    const RecordIndex& index(const size_t& i) const { return m_index[i]; }
+
+    RecordView view(const size_t& i) const;
+
+private:
+    std::vector<RecordIndex> m_index;
+    const uint8_t* m_data;
+    size_t m_length;
+};
+#endif // RECORD_H
@@ -0,0 +1,175 @@
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "pcloud.h"
+#include "record.h"
+
+static const char MAGIC[4] = { 'R', 'G', 'B', 'D' };
+static const uint32_t VERSION = 2;
+static const uint64_t CHUNK_ALIGNMENT = 64;
+
+// the header fills one alignment unit, so the first chunk is aligned too
+static const uint64_t HEADER_BYTES = CHUNK_ALIGNMENT;
+
+static uint64_t xyzBytes(const uint64_t& w, const uint64_t& h)
+{
+    return w * h * 3 * sizeof(int16_t);
+}
+
+static uint64_t bgraBytes(const uint64_t& w, const uint64_t& h)
+{
+    return w * h * 4 * sizeof(uint8_t);
+}
+
+static uint64_t align(const uint64_t& bytes)
+{
+    return (bytes + CHUNK_ALIGNMENT - 1) / CHUNK_ALIGNMENT * CHUNK_ALIGNMENT;
+}
+
+// drops a torn trailing record, which would misalign every index entry
+// appended after it; returns the index path
+static std::string wholeRecords(const std::string& file)
+{
+    struct stat info {};
+    if (stat(file.c_str(), &info) != 0) {
+        return file; // new recording
+    }
+    const off_t torn = info.st_size % (off_t)sizeof(RecordIndex);
+    if (torn != 0 && truncate(file.c_str(), info.st_size - torn) != 0) {
+        throw std::runtime_error("recorder: failed to truncate " + file);
+    }
+    return file;
+}
+
+Recorder::Recorder(const std::string& file)
+    : m_data(file, std::ios::out | std::ios::binary | std::ios::app)
+    , m_index(wholeRecords(file + ".idx"),
+          std::ios::out | std::ios::binary | std::ios::app)
+    , m_offset(0)
+    , m_frames(0)
+{
+    if (!m_data || !m_index) {
+        throw std::runtime_error("recorder: failed to open " + file);
+    }
+
+    // continue an existing recording, or start a new one
+    m_data.seekp(0, std::ios::end);
+    m_offset = (uint64_t)m_data.tellp();
+    m_index.seekp(0, std::ios::end);
+    m_frames = (size_t)m_index.tellp() / sizeof(RecordIndex);
+
+    if (m_offset == 0) {
+        char header[HEADER_BYTES] = {};
+        std::memcpy(header, MAGIC, sizeof(MAGIC));
+        std::memcpy(header + sizeof(MAGIC), &VERSION, sizeof(VERSION));
+        m_data.write(header, HEADER_BYTES);
+        m_offset = HEADER_BYTES;
+    }
+
+    // a chunk torn by an interrupted session was never indexed: pad past
+    // it so the next chunk starts aligned
+    const uint64_t padding = align(m_offset) - m_offset;
+    if (padding != 0) {
+        const char zeros[CHUNK_ALIGNMENT] = {};
+        m_data.write(zeros, (std::streamsize)padding);
+        m_offset += padding;
+    }
+}
+
+void Recorder::append(const uint64_t& timestamp, const int& w, const int& h,
+    const int16_t* pCloudData, const uint8_t* bgra)
+{
+    RecordIndex index {};
+    index.m_timestamp = timestamp;
+    index.m_offset = m_offset;
+    index.m_width = (uint32_t)w;
+    index.m_height = (uint32_t)h;
+    index.m_points = (uint32_t)pcloud::count(w, h, pCloudData, bgra);
+
+    const uint64_t xyz = xyzBytes(w, h);
+    const uint64_t color = bgraBytes(w, h);
+    const uint64_t padding = align(xyz + color) - (xyz + color);
+    const char zeros[CHUNK_ALIGNMENT] = {};
+
+    m_data.write((const char*)pCloudData, (std::streamsize)xyz);
+    m_data.write((const char*)bgra, (std::streamsize)color);
+    m_data.write(zeros, (std::streamsize)padding);
+    m_data.flush();
+
+    // index the chunk only once its data is on disk
+    m_index.write((const char*)&index, sizeof(index));
+    m_index.flush();
+
+    if (!m_data || !m_index) {
+        throw std::runtime_error("recorder: failed to append frame");
+    }
+    m_offset += xyz + color + padding;
+    m_frames++;
+}
+
+Recording::Recording(const std::string& file)
+    : m_data(nullptr)
+    , m_length(0)
+{
+    int fd = open(file.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("recording: failed to open " + file);
+    }
+    struct stat info {};
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        throw std::runtime_error("recording: failed to stat " + file);
+    }
+    m_length = (size_t)info.st_size;
+    if (m_length < HEADER_BYTES) {
+        close(fd);
+        throw std::runtime_error("recording: truncated header in " + file);
+    }
+    void* data = mmap(nullptr, m_length, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        throw std::runtime_error("recording: failed to map " + file);
+    }
+    m_data = (const uint8_t*)data;
+    if (std::memcmp(m_data, MAGIC, sizeof(MAGIC)) != 0) {
+        munmap(data, m_length);
+        throw std::runtime_error("recording: not an rgbd recording " + file);
+    }
+
+    // keep every indexed frame whose chunk made it to disk
+    std::ifstream ifs(file + ".idx", std::ios::in | std::ios::binary);
+    RecordIndex index {};
+    while (ifs.read((char*)&index, sizeof(index))) {
+        uint64_t end = index.m_offset
+            + xyzBytes(index.m_width, index.m_height)
+            + bgraBytes(index.m_width, index.m_height);
+        if (end > m_length) {
+            break;
+        }
+        m_index.push_back(index);
+    }
+}
+
+Recording::~Recording()
+{
+    munmap((void*)m_data, m_length);
+}
+
+RecordView Recording::view(const size_t& i) const
+{
+    const RecordIndex& index = m_index.at(i);
+    const uint8_t* chunk = m_data + index.m_offset;
+
+    RecordView view {};
+    view.m_timestamp = index.m_timestamp;
+    view.m_width = (int)index.m_width;
+    view.m_height = (int)index.m_height;
+    view.m_points = index.m_points;
+    view.m_pCloudData = (const int16_t*)(const void*)chunk;
+    view.m_bgra = chunk + xyzBytes(index.m_width, index.m_height);
+    return view;
+}
@@ -0,0 +1,81 @@
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <condition_variable>
+#include <mutex>
+#include <opencv2/core.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "detector.h"
+
+struct CalibrationResult {
+    size_t m_views; // number of views the solve used (0: no solve yet)
+    double m_rms;   // re-projection error (px)
+    cv::Mat m_K;
+    cv::Mat m_distortionCoefficients;
+};
+
+/* corner-only calibration session:
+ *   each captured view keeps its refined corners (and, optionally, a
+ *   small thumbnail) rather than the full frame; once enough views are
+ *   in, a background thread re-solves after every new view, starting
+ *   from the previous solution, so the final result is ready (or nearly
+ *   so) by the time the user asks for it; a solve that fails (e.g., on
+ *   degenerate views) keeps the previous solution
+ */
+class CalibrationSession {
+public:
+    // squareWidth: chessboard square size, in the units K should use
+    CalibrationSession(const cv::Size& dChessboard, const float& squareWidth,
+        const size_t& minViews = 15, const double& thumbnailScale = 0.0);
+    ~CalibrationSession();
+
+    CalibrationSession(const CalibrationSession&) = delete;
+    CalibrationSession& operator=(const CalibrationSession&) = delete;
+
+    // keep a successful detection's corners; false if it has none
+    bool add(const Detection& detection);
+
+    // detect and add full frames (e.g., loaded from disk) in parallel;
+    // returns the number of views added
+    size_t add(const std::vector<cv::Mat>& frames, const double& scale = 0.5);
+
+    size_t views() const;
+
+    bool ready() const { return views() >= m_minViews; }
+
+    // only safe to call from the thread that adds views
+    const std::vector<cv::Mat>& thumbnails() const { return m_thumbnails; }
+
+    // newest finished solve, without waiting
+    CalibrationResult latest() const;
+
+    // solve covering every view added so far (waits if one is running);
+    // if that solve failed, the newest one that succeeded
+    CalibrationResult result();
+
+    // why the newest solve failed (empty: it did not)
+    std::string error() const;
+
+private:
+    void solve();
+
+    cv::Size m_dChessboard;
+    std::vector<cv::Point3f> m_board;
+    size_t m_minViews;
+    double m_thumbnailScale;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_changed;
+    std::vector<std::vector<cv::Point2f>> m_corners;
+    std::vector<cv::Mat> m_thumbnails;
+    cv::Size m_imageSize;
+    CalibrationResult m_result;
+    size_t m_attempted; // views the newest solve, failed or not, covered
+    std::string m_error;
+    bool m_running;
+    std::thread m_solver;
+};
+#endif // SESSION_H
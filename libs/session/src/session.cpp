@@ -0,0 +1,160 @@
+#include <iostream>
+#include <opencv2/calib3d.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "session.h"
+
+CalibrationSession::CalibrationSession(const cv::Size& dChessboard,
+    const float& squareWidth, const size_t& minViews,
+    const double& thumbnailScale)
+    : m_dChessboard(dChessboard)
+    , m_minViews(minViews)
+    , m_thumbnailScale(thumbnailScale)
+    , m_result { 0, 0.0, cv::Mat(), cv::Mat() }
+    , m_attempted(0)
+    , m_running(true)
+{
+    // board corners in the board's own plane (z = 0), row-major
+    for (int y = 0; y < dChessboard.height; y++) {
+        for (int x = 0; x < dChessboard.width; x++) {
+            m_board.emplace_back(
+                (float)x * squareWidth, (float)y * squareWidth, 0.0f);
+        }
+    }
+    m_solver = std::thread([this]() { solve(); });
+}
+
+CalibrationSession::~CalibrationSession()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_changed.notify_all();
+    m_solver.join();
+}
+
+bool CalibrationSession::add(const Detection& detection)
+{
+    if (!detection.m_found || detection.m_frame.empty()) {
+        return false;
+    }
+    cv::Mat thumbnail;
+    if (m_thumbnailScale > 0) {
+        cv::resize(detection.m_frame, thumbnail, cv::Size(), m_thumbnailScale,
+            m_thumbnailScale, cv::INTER_AREA);
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_imageSize.empty()) {
+            m_imageSize = detection.m_frame.size();
+        } else if (m_imageSize != detection.m_frame.size()) {
+            return false;
+        }
+        m_corners.push_back(detection.m_corners);
+        if (!thumbnail.empty()) {
+            m_thumbnails.push_back(thumbnail);
+        }
+    }
+    m_changed.notify_all();
+    return true;
+}
+
+size_t CalibrationSession::add(
+    const std::vector<cv::Mat>& frames, const double& scale)
+{
+    std::vector<Detection> detections(frames.size());
+    cv::parallel_for_(cv::Range(0, (int)frames.size()),
+        [&](const cv::Range& range) {
+            for (int i = range.start; i < range.end; i++) {
+                detections[i] = ChessboardDetector::detect(
+                    frames[i], m_dChessboard, scale);
+            }
+        });
+
+    // add in capture order, whatever order the searches finished in
+    size_t added = 0;
+    for (const auto& detection : detections) {
+        added += add(detection) ? 1 : 0;
+    }
+    return added;
+}
+
+size_t CalibrationSession::views() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_corners.size();
+}
+
+CalibrationResult CalibrationSession::latest() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_result;
+}
+
+CalibrationResult CalibrationSession::result()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_changed.wait(lock, [&]() {
+        return m_corners.size() < m_minViews
+            || m_attempted == m_corners.size();
+    });
+    return m_result;
+}
+
+std::string CalibrationSession::error() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_error;
+}
+
+void CalibrationSession::solve()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_changed.wait(lock, [&]() {
+            return !m_running
+                || (m_corners.size() >= m_minViews
+                    && m_corners.size() > m_attempted);
+        });
+        if (!m_running) {
+            return;
+        }
+
+        // solve a snapshot, so views can keep coming in meanwhile
+        std::vector<std::vector<cv::Point2f>> corners = m_corners;
+        const cv::Size imageSize = m_imageSize;
+        CalibrationResult previous = m_result;
+        lock.unlock();
+
+        // start from the previous solution, if there is one
+        cv::Mat K, distortionCoefficients;
+        int flags = 0;
+        if (previous.m_views > 0) {
+            K = previous.m_K.clone();
+            distortionCoefficients = previous.m_distortionCoefficients.clone();
+            flags |= cv::CALIB_USE_INTRINSIC_GUESS;
+        }
+        std::vector<std::vector<cv::Point3f>> board(corners.size(), m_board);
+        std::vector<cv::Mat> R, t;
+        double rms = 0.0;
+        std::string error;
+        try {
+            rms = cv::calibrateCamera(board, corners, imageSize, K,
+                distortionCoefficients, R, t, flags);
+        } catch (const cv::Exception& e) {
+            // an escaping exception would terminate the process
+            error = e.what();
+            std::cerr << "-- calibration with " << corners.size()
+                      << " views failed: " << error << std::endl;
+        }
+
+        lock.lock();
+        if (error.empty()) {
+            m_result = { corners.size(), rms, K, distortionCoefficients };
+        }
+        m_attempted = corners.size();
+        m_error = error;
+        m_changed.notify_all();
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef SPECTRUM_H
+#define SPECTRUM_H
+
+#include <map>
+#include <opencv2/core.hpp>
+#include <utility>
+
+/* frequency-domain helpers:
+ *   real-input transforms on buffers zero-padded to getOptimalDFTSize,
+ *   reused across same-sized frames; the default spectrum layout is the
+ *   packed CCS one cv::dft produces for real input (half the work and
+ *   memory of a complex transform)
+ */
+class Spectrum {
+public:
+    Spectrum() = default;
+
+    // src: single channel; minimum: smallest padded size accepted, e.g.,
+    // to leave room for linear convolution; flags: 0 (CCS) or
+    // cv::DFT_COMPLEX_OUTPUT. the returned spectrum is valid until the
+    // next call
+    const cv::Mat& forward(const cv::Mat& src, const int& flags = 0,
+        const cv::Size& minimum = cv::Size());
+
+    // real image of the last forward()'s size from a spectrum of the
+    // padded size
+    void inverse(const cv::Mat& spectrum, cv::Mat& dst);
+
+    const cv::Size& padded() const { return m_padded; }
+
+    // in-place fft shift, moving the zero frequency to the center
+    static void recenter(cv::Mat& image);
+
+private:
+    cv::Size m_size;
+    cv::Size m_padded;
+    cv::Mat m_buffer;
+    cv::Mat m_spectrum;
+    cv::Mat m_inverse;
+};
+
+/* streaming spectral filter:
+ *   forward -> multiply by the kernel's spectrum -> inverse, giving the
+ *   same result as cv::filter2D(src, dst, CV_32F, kernel) with a zero
+ *   (BORDER_CONSTANT) border; kernel spectra are cached per padded size
+ */
+class SpectralFilter {
+public:
+    explicit SpectralFilter(const cv::Mat& kernel);
+
+    // src: CV_32FC1; dst: CV_32FC1 of src's size
+    void apply(const cv::Mat& src, cv::Mat& dst);
+
+private:
+    const cv::Mat& kernelSpectrum(const cv::Size& padded);
+
+    cv::Mat m_kernel;
+    Spectrum m_spectrum;
+    cv::Mat m_product;
+    std::map<std::pair<int, int>, cv::Mat> m_cache;
+};
+#endif // SPECTRUM_H
@@ -0,0 +1,95 @@
+#include <algorithm>
+
+#include "spectrum.h"
+
+const cv::Mat& Spectrum::forward(
+    const cv::Mat& src, const int& flags, const cv::Size& minimum)
+{
+    CV_Assert(src.channels() == 1);
+    m_size = src.size();
+    m_padded = cv::Size(
+        cv::getOptimalDFTSize(std::max(src.cols, minimum.width)),
+        cv::getOptimalDFTSize(std::max(src.rows, minimum.height)));
+
+    // zero only the padding: the image area is overwritten below
+    m_buffer.create(m_padded, CV_32FC1);
+    cv::Mat image = m_buffer(cv::Rect(cv::Point(0, 0), m_size));
+    src.convertTo(image, CV_32F);
+    if (m_padded.width > m_size.width) {
+        m_buffer(cv::Rect(m_size.width, 0, m_padded.width - m_size.width,
+                     m_size.height))
+            .setTo(0);
+    }
+    if (m_padded.height > m_size.height) {
+        m_buffer.rowRange(m_size.height, m_padded.height).setTo(0);
+    }
+
+    // nonzeroRows: the padded rows are skipped by the row transforms
+    cv::dft(m_buffer, m_spectrum, flags, m_size.height);
+    return m_spectrum;
+}
+
+void Spectrum::inverse(const cv::Mat& spectrum, cv::Mat& dst)
+{
+    cv::dft(spectrum, m_inverse,
+        cv::DFT_INVERSE | cv::DFT_REAL_OUTPUT | cv::DFT_SCALE);
+    m_inverse(cv::Rect(cv::Point(0, 0), m_size)).copyTo(dst);
+}
+
+void Spectrum::recenter(cv::Mat& image)
+{
+    CV_Assert(image.isContinuous());
+    const size_t elem = image.elemSize();
+    const size_t row = image.cols * elem;
+
+    // element k moves to (k + n / 2) mod n, along both axes
+    const size_t cols = image.cols - image.cols / 2;
+    for (int y = 0; y < image.rows; y++) {
+        uchar* p = image.ptr(y);
+        std::rotate(p, p + cols * elem, p + row);
+    }
+    const size_t rows = image.rows - image.rows / 2;
+    std::rotate(image.data, image.data + rows * row,
+        image.data + image.rows * row);
+}
+
+SpectralFilter::SpectralFilter(const cv::Mat& kernel)
+{
+    kernel.convertTo(m_kernel, CV_32F);
+}
+
+const cv::Mat& SpectralFilter::kernelSpectrum(const cv::Size& padded)
+{
+    auto key = std::make_pair(padded.width, padded.height);
+    auto cached = m_cache.find(key);
+    if (cached != m_cache.end()) {
+        return cached->second;
+    }
+
+    // filter2D correlates with the kernel anchored at its center: place
+    // kernel (i, j) at (anchor - (i, j)) mod padded, i.e., flipped and
+    // wrapped around the origin
+    cv::Mat wrapped = cv::Mat::zeros(padded, CV_32FC1);
+    const cv::Point anchor(m_kernel.cols / 2, m_kernel.rows / 2);
+    for (int y = 0; y < m_kernel.rows; y++) {
+        for (int x = 0; x < m_kernel.cols; x++) {
+            int u = (anchor.x - x + padded.width) % padded.width;
+            int v = (anchor.y - y + padded.height) % padded.height;
+            wrapped.at<float>(v, u) = m_kernel.at<float>(y, x);
+        }
+    }
+    cv::Mat spectrum;
+    cv::dft(wrapped, spectrum);
+    return m_cache.emplace(key, spectrum).first->second;
+}
+
+void SpectralFilter::apply(const cv::Mat& src, cv::Mat& dst)
+{
+    // room for the kernel on either side: no circular wrap-around
+    const cv::Size minimum(
+        src.cols + m_kernel.cols - 1, src.rows + m_kernel.rows - 1);
+    const cv::Mat& spectrum = m_spectrum.forward(src, 0, minimum);
+    cv::mulSpectrums(
+        spectrum, kernelSpectrum(m_spectrum.padded()), m_product, 0);
+    m_spectrum.inverse(m_product, dst);
+}
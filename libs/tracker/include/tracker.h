@@ -0,0 +1,71 @@
+#ifndef TRACKER_H
+#define TRACKER_H
+
+#include <functional>
+#include <opencv2/core.hpp>
+
+/* projection-area tracker:
+ *   keeps the last boundary and, per frame, compares a band straddling
+ *   each of its four edges against the first frame tracked after the
+ *   boundary was found (segmentation flashes the projector, so frames
+ *   from before it would not match the settled scene);
+ *   full segmentation (flashing the projector) only reruns when the mean
+ *   absolute difference of any band exceeds the threshold
+ */
+struct TrackerStats {
+    size_t m_hits;   // frames answered from the last boundary
+    size_t m_misses; // frames that reran segmentation
+
+    double hitRate() const
+    {
+        size_t frames = m_hits + m_misses;
+        return frames == 0 ? 0.0 : (double)m_hits / (double)frames;
+    }
+};
+
+class ProjectionTracker {
+public:
+    // segment(): full segmentation, returns the new boundary
+    explicit ProjectionTracker(std::function<cv::Rect()> segment,
+        const int& band = 8, const double& threshold = 12.0);
+
+    // boundary for this frame, re-segmenting if the edge bands changed
+    const cv::Rect& track(const cv::Mat& frame);
+
+    // start from a boundary segmentation already produced: the next frame
+    // becomes the reference instead of re-segmenting
+    void seed(const cv::Rect& boundary)
+    {
+        m_boundary = boundary;
+        m_reference.release();
+        m_seed = true;
+    }
+
+    // force segmentation on the next frame
+    void invalidate()
+    {
+        m_reference.release();
+        m_seed = false;
+    }
+
+    const cv::Rect& boundary() const { return m_boundary; }
+
+    TrackerStats stats() const { return { m_hits, m_misses }; }
+
+private:
+    bool changed(const cv::Mat& gray);
+
+    std::function<cv::Rect()> m_segment;
+    int m_band;
+    double m_threshold;
+
+    cv::Rect m_boundary;
+    cv::Mat m_reference;
+    cv::Mat m_gray;
+    cv::Mat m_diff;
+    bool m_seed; // next frame becomes the reference
+
+    size_t m_hits;
+    size_t m_misses;
+};
+#endif // TRACKER_H
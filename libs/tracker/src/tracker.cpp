@@ -0,0 +1,76 @@
+#include <opencv2/imgproc.hpp>
+
+#include "tracker.h"
+
+ProjectionTracker::ProjectionTracker(
+    std::function<cv::Rect()> segment, const int& band, const double& threshold)
+    : m_segment(std::move(segment))
+    , m_band(band)
+    , m_threshold(threshold)
+    , m_seed(false)
+    , m_hits(0)
+    , m_misses(0)
+{
+}
+
+const cv::Rect& ProjectionTracker::track(const cv::Mat& frame)
+{
+    switch (frame.channels()) {
+    case 4:
+        cv::cvtColor(frame, m_gray, cv::COLOR_BGRA2GRAY);
+        break;
+    case 3:
+        cv::cvtColor(frame, m_gray, cv::COLOR_BGR2GRAY);
+        break;
+    default:
+        frame.copyTo(m_gray);
+    }
+
+    if (m_seed) {
+        // first frame after segmentation: the projection has settled;
+        // swap rather than copy, the reference keeps this frame's buffer
+        cv::swap(m_reference, m_gray);
+        m_seed = false;
+        m_hits++;
+        return m_boundary;
+    }
+    if (!changed(m_gray)) {
+        m_hits++;
+        return m_boundary;
+    }
+    m_misses++;
+    m_boundary = m_segment();
+    m_seed = true;
+    return m_boundary;
+}
+
+bool ProjectionTracker::changed(const cv::Mat& gray)
+{
+    if (m_reference.empty() || m_reference.size() != gray.size()
+        || m_boundary.empty()) {
+        return true;
+    }
+
+    // one band per edge, m_band pixels either side of it
+    const cv::Rect& r = m_boundary;
+    const int b = m_band;
+    const cv::Rect bands[4] = {
+        cv::Rect(r.x - b, r.y - b, r.width + 2 * b, 2 * b), // top
+        cv::Rect(r.x - b, r.br().y - b, r.width + 2 * b, 2 * b), // bottom
+        cv::Rect(r.x - b, r.y - b, 2 * b, r.height + 2 * b), // left
+        cv::Rect(r.br().x - b, r.y - b, 2 * b, r.height + 2 * b) // right
+    };
+    const cv::Rect image(cv::Point(0, 0), gray.size());
+
+    for (const auto& band : bands) {
+        cv::Rect roi = band & image;
+        if (roi.empty()) {
+            continue;
+        }
+        cv::absdiff(gray(roi), m_reference(roi), m_diff);
+        if (cv::mean(m_diff)[0] > m_threshold) {
+            return true;
+        }
+    }
+    return false;
+}
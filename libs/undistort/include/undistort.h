@@ -0,0 +1,42 @@
+#ifndef UNDISTORT_H
+#define UNDISTORT_H
+
+#include <opencv2/core.hpp>
+#include <string>
+
+/* undistortion engine:
+ *   builds fixed-point (CV_16SC2 + CV_16UC1) remap tables once per set of
+ *   calibration parameters and image size, so each frame only costs a
+ *   remap; the tables are cached next to the calibration file as
+ *   undistort-<hash>.bin, keyed by an FNV-1a hash of K, the distortion
+ *   coefficients, alpha and the image size, and later runs load them
+ *   instead of recomputing them
+ */
+class Undistorter {
+public:
+    // file: calibration file the parameters were read from
+    Undistorter(const std::string& file, const cv::Mat& K,
+        const cv::Mat& distortionCoefficients, const cv::Size& size,
+        const double& alpha = 1.0);
+
+    // dst is (re)allocated only if its size or type differ; tiles > 1
+    // splits the remap into row bands run in parallel
+    void apply(const cv::Mat& src, cv::Mat& dst, const int& tiles = 1) const;
+
+    // camera matrix of the undistorted image
+    const cv::Mat& refinedK() const { return m_refinedK; }
+
+    // true iff the tables were loaded from the cache
+    bool cached() const { return m_cached; }
+
+private:
+    bool load(const std::string& path, const uint64_t& key);
+    void save(const std::string& path, const uint64_t& key) const;
+
+    cv::Size m_size;
+    cv::Mat m_refinedK;
+    cv::Mat m_map1;
+    cv::Mat m_map2;
+    bool m_cached;
+};
+#endif // UNDISTORT_H
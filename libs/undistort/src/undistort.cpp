@@ -0,0 +1,162 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <opencv2/calib3d.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "undistort.h"
+
+static const char MAGIC[4] = { 'U', 'N', 'D', 'M' };
+static const uint32_t VERSION = 1;
+
+namespace {
+struct CacheHeader {
+    char m_magic[4];
+    uint32_t m_version;
+    uint64_t m_key;
+    int32_t m_width;
+    int32_t m_height;
+};
+
+// 64-bit FNV-1a
+class Fnv {
+public:
+    Fnv()
+        : m_hash(14695981039346656037ull)
+    {
+    }
+
+    void add(const void* data, const size_t& bytes)
+    {
+        auto p = (const uint8_t*)data;
+        for (size_t i = 0; i < bytes; i++) {
+            m_hash = (m_hash ^ p[i]) * 1099511628211ull;
+        }
+    }
+
+    // hash values, not layout: matrices are added as contiguous doubles
+    void add(const cv::Mat& mat)
+    {
+        cv::Mat values;
+        mat.convertTo(values, CV_64F);
+        values = values.reshape(1, 1).clone();
+        add(values.data, values.total() * values.elemSize());
+    }
+
+    uint64_t value() const { return m_hash; }
+
+private:
+    uint64_t m_hash;
+};
+}
+
+static std::string directory(const std::string& file)
+{
+    size_t slash = file.find_last_of('/');
+    return slash == std::string::npos ? "." : file.substr(0, slash);
+}
+
+Undistorter::Undistorter(const std::string& file, const cv::Mat& K,
+    const cv::Mat& distortionCoefficients, const cv::Size& size,
+    const double& alpha)
+    : m_size(size)
+    , m_cached(false)
+{
+    m_refinedK = cv::getOptimalNewCameraMatrix(
+        K, distortionCoefficients, size, alpha, size);
+
+    Fnv fnv;
+    fnv.add(K);
+    fnv.add(distortionCoefficients);
+    fnv.add(&alpha, sizeof(alpha));
+    fnv.add(&size.width, sizeof(size.width));
+    fnv.add(&size.height, sizeof(size.height));
+    const uint64_t key = fnv.value();
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "undistort-%016llx.bin",
+        (unsigned long long)key);
+    const std::string path = directory(file) + "/" + name;
+
+    if (load(path, key)) {
+        m_cached = true;
+        return;
+    }
+    cv::initUndistortRectifyMap(K, distortionCoefficients, cv::Mat(),
+        m_refinedK, size, CV_16SC2, m_map1, m_map2);
+    save(path, key);
+}
+
+void Undistorter::apply(
+    const cv::Mat& src, cv::Mat& dst, const int& tiles) const
+{
+    CV_Assert(src.size() == m_size);
+    if (tiles <= 1) {
+        cv::remap(src, dst, m_map1, m_map2, cv::INTER_LINEAR);
+        return;
+    }
+
+    // each band reads all of src but writes only its own rows of dst
+    dst.create(m_size, src.type());
+    const int rows = (m_size.height + tiles - 1) / tiles;
+    cv::parallel_for_(cv::Range(0, tiles), [&](const cv::Range& range) {
+        for (int t = range.start; t < range.end; t++) {
+            cv::Range band(std::min(m_size.height, t * rows),
+                std::min(m_size.height, (t + 1) * rows));
+            if (band.empty()) {
+                continue;
+            }
+            cv::Mat out = dst.rowRange(band);
+            cv::remap(src, out, m_map1.rowRange(band), m_map2.rowRange(band),
+                cv::INTER_LINEAR);
+        }
+    });
+}
+
+bool Undistorter::load(const std::string& path, const uint64_t& key)
+{
+    std::ifstream ifs(path, std::ios::in | std::ios::binary);
+    CacheHeader header {};
+    if (!ifs.read((char*)&header, sizeof(header))) {
+        return false;
+    }
+    if (std::memcmp(header.m_magic, MAGIC, sizeof(MAGIC)) != 0
+        || header.m_version != VERSION || header.m_key != key
+        || header.m_width != m_size.width
+        || header.m_height != m_size.height) {
+        return false;
+    }
+
+    cv::Mat map1(m_size, CV_16SC2);
+    cv::Mat map2(m_size, CV_16UC1);
+    auto bytes1 = (std::streamsize)(map1.total() * map1.elemSize());
+    auto bytes2 = (std::streamsize)(map2.total() * map2.elemSize());
+    if (!ifs.read((char*)map1.data, bytes1)
+        || !ifs.read((char*)map2.data, bytes2)) {
+        return false;
+    }
+    m_map1 = map1;
+    m_map2 = map2;
+    return true;
+}
+
+void Undistorter::save(const std::string& path, const uint64_t& key) const
+{
+    // the cache is an optimization: failing to write it is not an error
+    std::ofstream ofs(path, std::ios::out | std::ios::binary);
+    if (!ofs) {
+        return;
+    }
+    CacheHeader header {};
+    std::memcpy(header.m_magic, MAGIC, sizeof(MAGIC));
+    header.m_version = VERSION;
+    header.m_key = key;
+    header.m_width = m_size.width;
+    header.m_height = m_size.height;
+
+    ofs.write((const char*)&header, sizeof(header));
+    ofs.write((const char*)m_map1.data,
+        (std::streamsize)(m_map1.total() * m_map1.elemSize()));
+    ofs.write((const char*)m_map2.data,
+        (std::streamsize)(m_map2.total() * m_map2.elemSize()));
+}
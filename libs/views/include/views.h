@@ -0,0 +1,54 @@
+#ifndef VIEWS_H
+#define VIEWS_H
+
+#include <opencv2/core.hpp>
+#include <string>
+#include <vector>
+
+/* compact projector calibration views:
+ *   a view keeps only the 3D (camera frame, mm) points under the detected
+ *   chessboard corners, looked up directly in the organized k4a point
+ *   cloud image, i.e., a few hundred bytes per view instead of a frame
+ *   plus a compacted cloud
+ */
+struct ProjectorView {
+    std::vector<cv::Point2f> m_imagePoints;  // corners in the camera image
+    std::vector<cv::Point3f> m_objectPoints; // xyz under each corner
+};
+
+class ProjectorViews {
+public:
+    explicit ProjectorViews(const cv::Size& dChessboard);
+
+    // image: the 8-bit image the corners were found in (decides the
+    // board's orientation); xyz: organized CV_16SC3 point cloud image
+    // registered with it; false if a corner has no depth
+    bool add(const std::vector<cv::Point2f>& corners, const cv::Mat& image,
+        const cv::Mat& xyz);
+
+    size_t size() const { return m_views.size(); }
+
+    const std::vector<ProjectorView>& views() const { return m_views; }
+
+    // solve projector intrinsics from the corners of the projected
+    // pattern (projector pixels); returns the re-projection error
+    double calibrate(const std::vector<cv::Point2f>& projectorCorners,
+        const cv::Size& projectorSize, cv::Mat& K,
+        cv::Mat& distortionCoefficients) const;
+
+    // rms re-projection error (px) of K and the distortion coefficients
+    // over the recorded views, each view posed on its own (solvePnP); the
+    // same measure for any solver's output, e.g., to compare solutions
+    double reprojectionError(const std::vector<cv::Point2f>& projectorCorners,
+        const cv::Mat& K, const cv::Mat& distortionCoefficients) const;
+
+    // corners of the projected chessboard, found once in its image and
+    // scaled to projector pixels (the pattern fills the projector)
+    static std::vector<cv::Point2f> projectorCorners(const std::string& path,
+        const cv::Size& dChessboard, const cv::Size& projectorSize);
+
+private:
+    cv::Size m_dChessboard;
+    std::vector<ProjectorView> m_views;
+};
+#endif // VIEWS_H
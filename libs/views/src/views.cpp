@@ -0,0 +1,174 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <opencv2/calib3d.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "views.h"
+
+// depth holes: search this far (px) around a corner for valid points
+static const int HOLE_RADIUS = 1;
+
+// mean of the valid (z != 0) points in the corner's neighbourhood
+static bool lookup(const cv::Mat& xyz, const cv::Point2f& corner,
+    cv::Point3f& point)
+{
+    const int u = cvRound(corner.x);
+    const int v = cvRound(corner.y);
+    cv::Point3f sum(0, 0, 0);
+    int n = 0;
+    for (int y = v - HOLE_RADIUS; y <= v + HOLE_RADIUS; y++) {
+        if (y < 0 || y >= xyz.rows) {
+            continue;
+        }
+        const auto* row = xyz.ptr<cv::Vec3s>(y);
+        for (int x = u - HOLE_RADIUS; x <= u + HOLE_RADIUS; x++) {
+            if (x < 0 || x >= xyz.cols || row[x][2] == 0) {
+                continue;
+            }
+            sum += cv::Point3f(row[x][0], row[x][1], row[x][2]);
+            n++;
+        }
+    }
+    if (n == 0) {
+        return false;
+    }
+    point = sum * (1.0f / (float)n);
+    return true;
+}
+
+// mean channel value of an 8-bit image at p (-1: outside the image)
+static double intensity(const cv::Mat& image, const cv::Point2f& p)
+{
+    const int u = cvRound(p.x);
+    const int v = cvRound(p.y);
+    if (u < 0 || v < 0 || u >= image.cols || v >= image.rows) {
+        return -1;
+    }
+    const uchar* px = image.ptr<uchar>(v) + u * image.channels();
+    double sum = 0;
+    for (int c = 0; c < image.channels(); c++) {
+        sum += px[c];
+    }
+    return sum / image.channels();
+}
+
+// findChessboardCorners may return the board rotated by 180 degrees;
+// with one odd dimension the two end squares differ in colour, so
+// reorder the corners until the square beyond the first one is the
+// darker of it and its neighbour along the first row
+static void orient(const cv::Mat& image, std::vector<cv::Point2f>& corners,
+    const cv::Size& dChessboard)
+{
+    const cv::Point2f c = corners[0];
+    const cv::Point2f dx = (corners[1] - c) * 0.5f;
+    const cv::Point2f dy = (corners[dChessboard.width] - c) * 0.5f;
+    const double origin = intensity(image, c - dx - dy);
+    const double next = intensity(image, c + dx - dy);
+    if (origin >= 0 && next >= 0 && origin > next) {
+        // row-major grid: reversing is the 180 degree rotation
+        std::reverse(corners.begin(), corners.end());
+    }
+}
+
+ProjectorViews::ProjectorViews(const cv::Size& dChessboard)
+    : m_dChessboard(dChessboard)
+{
+}
+
+bool ProjectorViews::add(const std::vector<cv::Point2f>& corners,
+    const cv::Mat& image, const cv::Mat& xyz)
+{
+    CV_Assert(xyz.type() == CV_16SC3 && image.depth() == CV_8U);
+    if ((int)corners.size() != m_dChessboard.area()) {
+        return false;
+    }
+    ProjectorView view;
+    view.m_imagePoints = corners;
+    orient(image, view.m_imagePoints, m_dChessboard);
+    view.m_objectPoints.resize(corners.size());
+    for (size_t i = 0; i < corners.size(); i++) {
+        if (!lookup(xyz, view.m_imagePoints[i], view.m_objectPoints[i])) {
+            return false;
+        }
+    }
+    m_views.push_back(std::move(view));
+    return true;
+}
+
+double ProjectorViews::calibrate(
+    const std::vector<cv::Point2f>& projectorCorners,
+    const cv::Size& projectorSize, cv::Mat& K,
+    cv::Mat& distortionCoefficients) const
+{
+    std::vector<std::vector<cv::Point3f>> objectPoints;
+    for (const auto& view : m_views) {
+        objectPoints.push_back(view.m_objectPoints);
+    }
+    std::vector<std::vector<cv::Point2f>> imagePoints(
+        m_views.size(), projectorCorners);
+
+    // non-planar object points need an initial guess
+    K = (cv::Mat_<double>(3, 3) << projectorSize.width, 0,
+        projectorSize.width / 2.0, 0, projectorSize.width,
+        projectorSize.height / 2.0, 0, 0, 1);
+    distortionCoefficients = cv::Mat::zeros(5, 1, CV_64F);
+
+    std::vector<cv::Mat> R, t;
+    return cv::calibrateCamera(objectPoints, imagePoints, projectorSize, K,
+        distortionCoefficients, R, t, cv::CALIB_USE_INTRINSIC_GUESS);
+}
+
+double ProjectorViews::reprojectionError(
+    const std::vector<cv::Point2f>& projectorCorners, const cv::Mat& K,
+    const cv::Mat& distortionCoefficients) const
+{
+    double sum = 0;
+    size_t n = 0;
+    std::vector<cv::Point2f> projected;
+    for (const auto& view : m_views) {
+        cv::Mat R, t;
+        if (!cv::solvePnP(view.m_objectPoints, projectorCorners, K,
+                distortionCoefficients, R, t)) {
+            continue;
+        }
+        cv::projectPoints(
+            view.m_objectPoints, R, t, K, distortionCoefficients, projected);
+        for (size_t i = 0; i < projected.size(); i++) {
+            cv::Point2f d = projected[i] - projectorCorners[i];
+            sum += d.dot(d);
+        }
+        n += projected.size();
+    }
+    return n == 0 ? DBL_MAX : std::sqrt(sum / (double)n);
+}
+
+std::vector<cv::Point2f> ProjectorViews::projectorCorners(
+    const std::string& path, const cv::Size& dChessboard,
+    const cv::Size& projectorSize)
+{
+    std::vector<cv::Point2f> corners;
+    cv::Mat pattern = cv::imread(path, cv::IMREAD_GRAYSCALE);
+    if (pattern.empty()) {
+        return corners;
+    }
+    if (!cv::findChessboardCorners(pattern, dChessboard, corners)) {
+        corners.clear();
+        return corners;
+    }
+    cv::cornerSubPix(pattern, corners, cv::Size(11, 11), cv::Size(-1, -1),
+        cv::TermCriteria(
+            cv::TermCriteria::EPS + cv::TermCriteria::COUNT, 30, 0.1));
+    orient(pattern, corners, dChessboard);
+
+    // the pattern is shown stretched over the whole projector: pattern
+    // pixel centers to projector pixel centers
+    const double sx = (double)projectorSize.width / pattern.cols;
+    const double sy = (double)projectorSize.height / pattern.rows;
+    for (auto& corner : corners) {
+        corner.x = (float)((corner.x + 0.5) * sx - 0.5);
+        corner.y = (float)((corner.y + 0.5) * sy - 0.5);
+    }
+    return corners;
+}
@@ -0,0 +1,666 @@
+/* k4a replay:
+ *   device-free stand-in for libk4a.so, serving the subset of the k4a API
+ *   used by the Kinect wrapper and the examples
+ *
+ *   K4A_REPLAY_SOURCE : path to a recording written by Recorder (record.h);
+ *                       unset serves a synthetic 640x576 scene
+ *   K4A_REPLAY_RATE   : "realtime" (default) paces captures by their
+ *                       timestamps, "fast" serves them as fast as possible
+ *
+ * recordings hold depth-registered images, so the color image is served at
+ * depth resolution and color-to-depth transformation is a copy
+ */
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <k4a/k4a.h>
+
+#include "record.h"
+
+namespace {
+
+const int SYNTHETIC_WIDTH = 640;
+const int SYNTHETIC_HEIGHT = 576;
+const uint64_t SYNTHETIC_PERIOD = 33333; // usec, i.e., 30 fps
+
+class Source {
+public:
+    virtual ~Source() = default;
+    virtual int width() const = 0;
+    virtual int height() const = 0;
+    virtual uint64_t timestamp(const size_t& frame) const = 0;
+    virtual void depth(const size_t& frame, uint16_t* dst) const = 0;
+    virtual void bgra(const size_t& frame, uint8_t* dst) const = 0;
+    virtual void xyz(const size_t& frame, const uint16_t* depth,
+        int16_t* dst) const = 0;
+};
+
+class RecordingSource : public Source {
+public:
+    explicit RecordingSource(const std::string& file)
+        : m_recording(file)
+        , m_duration(0)
+    {
+        if (m_recording.size() == 0) {
+            throw std::runtime_error("k4a replay: empty recording " + file);
+        }
+        size_t n = m_recording.size();
+        uint64_t first = m_recording.index(0).m_timestamp;
+        uint64_t last = m_recording.index(n - 1).m_timestamp;
+        uint64_t period = n > 1 ? (last - first) / (n - 1) : SYNTHETIC_PERIOD;
+        m_duration = last - first + period;
+    }
+
+    int width() const override { return (int)m_recording.index(0).m_width; }
+
+    int height() const override { return (int)m_recording.index(0).m_height; }
+
+    // loop the recording with monotonically increasing timestamps
+    uint64_t timestamp(const size_t& frame) const override
+    {
+        size_t n = m_recording.size();
+        return m_recording.index(frame % n).m_timestamp
+            + (frame / n) * m_duration;
+    }
+
+    void depth(const size_t& frame, uint16_t* dst) const override
+    {
+        RecordView view = at(frame);
+        for (int i = 0; i < view.m_width * view.m_height; i++) {
+            dst[i] = (uint16_t)view.m_pCloudData[3 * i + 2];
+        }
+    }
+
+    void bgra(const size_t& frame, uint8_t* dst) const override
+    {
+        RecordView view = at(frame);
+        std::memcpy(dst, view.m_bgra, (size_t)view.m_width * view.m_height * 4);
+    }
+
+    void xyz(const size_t& frame, const uint16_t* /* depth */,
+        int16_t* dst) const override
+    {
+        RecordView view = at(frame);
+        std::memcpy(dst, view.m_pCloudData,
+            (size_t)view.m_width * view.m_height * 3 * sizeof(int16_t));
+    }
+
+private:
+    RecordView at(const size_t& frame) const
+    {
+        return m_recording.view(frame % m_recording.size());
+    }
+
+    Recording m_recording;
+    uint64_t m_duration;
+};
+
+// tilted plane with a moving bump, seen through a pinhole depth camera
+class SyntheticSource : public Source {
+public:
+    int width() const override { return SYNTHETIC_WIDTH; }
+
+    int height() const override { return SYNTHETIC_HEIGHT; }
+
+    uint64_t timestamp(const size_t& frame) const override
+    {
+        return frame * SYNTHETIC_PERIOD;
+    }
+
+    void depth(const size_t& frame, uint16_t* dst) const override
+    {
+        const int w = width();
+        const int h = height();
+        const float cx = (float)(frame % (size_t)w);
+        const float cy = (float)h / 2;
+        for (int r = 0; r < h; r++) {
+            for (int c = 0; c < w; c++) {
+                float dx = (float)c - cx;
+                float dy = (float)r - cy;
+                float bump = 150.0f * std::exp(-(dx * dx + dy * dy) / 5000.0f);
+                dst[r * w + c] = (uint16_t)(1000.0f + 0.5f * (float)r - bump);
+            }
+        }
+    }
+
+    void bgra(const size_t& frame, uint8_t* dst) const override
+    {
+        const int w = width();
+        const int h = height();
+        for (int r = 0; r < h; r++) {
+            for (int c = 0; c < w; c++) {
+                uint8_t* px = &dst[4 * (r * w + c)];
+                px[0] = (uint8_t)(c + frame);
+                px[1] = (uint8_t)r;
+                px[2] = (uint8_t)((c ^ r) + 2 * frame);
+                px[3] = 0xff;
+            }
+        }
+    }
+
+    void xyz(const size_t& /* frame */, const uint16_t* depth,
+        int16_t* dst) const override
+    {
+        const int w = width();
+        const int h = height();
+        const float f = 504.0f;
+        const float cx = (float)w / 2;
+        const float cy = (float)h / 2;
+        for (int r = 0; r < h; r++) {
+            for (int c = 0; c < w; c++) {
+                int i = r * w + c;
+                auto z = (float)depth[i];
+                dst[3 * i + 0] = (int16_t)(((float)c - cx) * z / f);
+                dst[3 * i + 1] = (int16_t)(((float)r - cy) * z / f);
+                dst[3 * i + 2] = (int16_t)z;
+            }
+        }
+    }
+};
+
+struct Image {
+    std::atomic<int> m_refs { 1 };
+    k4a_image_format_t m_format {};
+    int m_width = 0;
+    int m_height = 0;
+    int m_stride = 0;
+    uint64_t m_timestamp = 0;
+    std::vector<uint8_t> m_buffer;
+
+    // caller-owned memory (k4a_image_create_from_buffer)
+    uint8_t* m_external = nullptr;
+    size_t m_externalSize = 0;
+    k4a_memory_destroy_cb_t* m_release = nullptr;
+    void* m_releaseContext = nullptr;
+
+    // depth images remember where they came from, so the point-cloud
+    // transformation can serve the matching xyz frame
+    std::shared_ptr<const Source> m_source;
+    size_t m_frame = 0;
+
+    uint8_t* data() { return m_external ? m_external : m_buffer.data(); }
+
+    size_t size() const
+    {
+        return m_external ? m_externalSize : m_buffer.size();
+    }
+};
+
+struct Capture {
+    std::atomic<int> m_refs { 1 };
+    Image* m_color = nullptr;
+    Image* m_depth = nullptr;
+    Image* m_ir = nullptr;
+};
+
+struct Device {
+    std::shared_ptr<const Source> m_source;
+    bool m_realtime = true;
+    bool m_started = false;
+    size_t m_frame = 0;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+struct Transformation {
+    k4a_calibration_t m_calibration;
+};
+
+Image* image(k4a_image_t handle)
+{
+    return (Image*)(void*)handle;
+}
+
+Capture* capture(k4a_capture_t handle)
+{
+    return (Capture*)(void*)handle;
+}
+
+Device* device(k4a_device_t handle)
+{
+    return (Device*)(void*)handle;
+}
+
+void reference(Image* img)
+{
+    if (img) {
+        img->m_refs++;
+    }
+}
+
+void release(Image* img)
+{
+    if (img && --img->m_refs == 0) {
+        if (img->m_external && img->m_release) {
+            img->m_release(img->m_external, img->m_releaseContext);
+        }
+        delete img;
+    }
+}
+
+int stride(const k4a_image_format_t& format, const int& w)
+{
+    switch (format) {
+    case K4A_IMAGE_FORMAT_COLOR_BGRA32:
+        return 4 * w;
+    case K4A_IMAGE_FORMAT_DEPTH16:
+    case K4A_IMAGE_FORMAT_IR16:
+    case K4A_IMAGE_FORMAT_CUSTOM16:
+        return 2 * w;
+    case K4A_IMAGE_FORMAT_CUSTOM8:
+        return w;
+    default:
+        return 0;
+    }
+}
+
+Image* create(const k4a_image_format_t& format, const int& w, const int& h,
+    const int& strideBytes)
+{
+    auto* img = new Image;
+    img->m_format = format;
+    img->m_width = w;
+    img->m_height = h;
+    img->m_stride = strideBytes > 0 ? strideBytes : stride(format, w);
+    img->m_buffer.resize((size_t)img->m_stride * h);
+    return img;
+}
+
+// room for h rows of w pixels at the image's own stride
+bool fits(const Image* img, const int& w, const int& h, const size_t& bpp)
+{
+    const size_t row = (size_t)w * bpp;
+    return img && img->m_width == w && img->m_height == h
+        && (size_t)img->m_stride >= row
+        && img->size() >= (size_t)img->m_stride * (h - 1) + row;
+}
+
+// row by row: either side may be padded
+void copyRows(const uint8_t* src, const size_t& srcStride, uint8_t* dst,
+    const size_t& dstStride, const size_t& row, const int& rows)
+{
+    if (srcStride == row && dstStride == row) {
+        std::memcpy(dst, src, row * rows);
+        return;
+    }
+    for (int r = 0; r < rows; r++) {
+        std::memcpy(dst + r * dstStride, src + r * srcStride, row);
+    }
+}
+}
+
+uint32_t k4a_device_get_installed_count(void)
+{
+    return 1;
+}
+
+k4a_result_t k4a_device_open(uint32_t index, k4a_device_t* device_handle)
+{
+    if (index != 0 || !device_handle) {
+        return K4A_RESULT_FAILED;
+    }
+    auto* dev = new Device;
+    try {
+        const char* source = std::getenv("K4A_REPLAY_SOURCE");
+        if (source && *source) {
+            dev->m_source = std::make_shared<RecordingSource>(source);
+        } else {
+            dev->m_source = std::make_shared<SyntheticSource>();
+        }
+    } catch (const std::exception&) {
+        delete dev;
+        return K4A_RESULT_FAILED;
+    }
+    const char* rate = std::getenv("K4A_REPLAY_RATE");
+    dev->m_realtime = !(rate && std::string(rate) == "fast");
+    *device_handle = (k4a_device_t)(void*)dev;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+void k4a_device_close(k4a_device_t device_handle)
+{
+    delete device(device_handle);
+}
+
+k4a_result_t k4a_device_start_cameras(
+    k4a_device_t device_handle, const k4a_device_configuration_t* config)
+{
+    Device* dev = device(device_handle);
+    if (!dev || !config) {
+        return K4A_RESULT_FAILED;
+    }
+    dev->m_started = true;
+    dev->m_frame = 0;
+    dev->m_start = std::chrono::steady_clock::now();
+    return K4A_RESULT_SUCCEEDED;
+}
+
+void k4a_device_stop_cameras(k4a_device_t device_handle)
+{
+    if (device(device_handle)) {
+        device(device_handle)->m_started = false;
+    }
+}
+
+k4a_result_t k4a_device_start_imu(k4a_device_t /* device_handle */)
+{
+    return K4A_RESULT_FAILED;
+}
+
+void k4a_device_stop_imu(k4a_device_t /* device_handle */) { }
+
+k4a_buffer_result_t k4a_device_get_serialnum(k4a_device_t /* device_handle */,
+    char* serial_number, size_t* serial_number_size)
+{
+    const std::string serial = "k4a-replay";
+    if (!serial_number_size) {
+        return K4A_BUFFER_RESULT_FAILED;
+    }
+    if (!serial_number || *serial_number_size < serial.size() + 1) {
+        *serial_number_size = serial.size() + 1;
+        return K4A_BUFFER_RESULT_TOO_SMALL;
+    }
+    std::memcpy(serial_number, serial.c_str(), serial.size() + 1);
+    *serial_number_size = serial.size() + 1;
+    return K4A_BUFFER_RESULT_SUCCEEDED;
+}
+
+k4a_result_t k4a_device_get_calibration(k4a_device_t device_handle,
+    const k4a_depth_mode_t depth_mode,
+    const k4a_color_resolution_t color_resolution,
+    k4a_calibration_t* calibration)
+{
+    Device* dev = device(device_handle);
+    if (!dev || !calibration) {
+        return K4A_RESULT_FAILED;
+    }
+    std::memset(calibration, 0, sizeof(*calibration));
+    calibration->depth_mode = depth_mode;
+    calibration->color_resolution = color_resolution;
+    calibration->depth_camera_calibration.resolution_width
+        = dev->m_source->width();
+    calibration->depth_camera_calibration.resolution_height
+        = dev->m_source->height();
+    calibration->color_camera_calibration.resolution_width
+        = dev->m_source->width();
+    calibration->color_camera_calibration.resolution_height
+        = dev->m_source->height();
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_wait_result_t k4a_device_get_capture(k4a_device_t device_handle,
+    k4a_capture_t* capture_handle, int32_t /* timeout_in_ms */)
+{
+    Device* dev = device(device_handle);
+    if (!dev || !dev->m_started || !capture_handle) {
+        return K4A_WAIT_RESULT_FAILED;
+    }
+    const Source& source = *dev->m_source;
+    const size_t frame = dev->m_frame++;
+    const uint64_t timestamp = source.timestamp(frame);
+
+    // timestamp-faithful pacing relative to the first capture
+    if (dev->m_realtime) {
+        uint64_t elapsed = timestamp - source.timestamp(0);
+        std::this_thread::sleep_until(
+            dev->m_start + std::chrono::microseconds(elapsed));
+    }
+
+    const int w = source.width();
+    const int h = source.height();
+
+    Image* depth = create(K4A_IMAGE_FORMAT_DEPTH16, w, h, 0);
+    source.depth(frame, (uint16_t*)(void*)depth->data());
+    depth->m_timestamp = timestamp;
+    depth->m_source = dev->m_source;
+    depth->m_frame = frame;
+
+    Image* color = create(K4A_IMAGE_FORMAT_COLOR_BGRA32, w, h, 0);
+    source.bgra(frame, color->data());
+    color->m_timestamp = timestamp;
+
+    auto* cap = new Capture;
+    cap->m_depth = depth;
+    cap->m_color = color;
+    *capture_handle = (k4a_capture_t)(void*)cap;
+    return K4A_WAIT_RESULT_SUCCEEDED;
+}
+
+k4a_result_t k4a_capture_create(k4a_capture_t* capture_handle)
+{
+    if (!capture_handle) {
+        return K4A_RESULT_FAILED;
+    }
+    *capture_handle = (k4a_capture_t)(void*)new Capture;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+void k4a_capture_reference(k4a_capture_t capture_handle)
+{
+    if (capture(capture_handle)) {
+        capture(capture_handle)->m_refs++;
+    }
+}
+
+void k4a_capture_release(k4a_capture_t capture_handle)
+{
+    Capture* cap = capture(capture_handle);
+    if (cap && --cap->m_refs == 0) {
+        release(cap->m_color);
+        release(cap->m_depth);
+        release(cap->m_ir);
+        delete cap;
+    }
+}
+
+k4a_image_t k4a_capture_get_color_image(k4a_capture_t capture_handle)
+{
+    Capture* cap = capture(capture_handle);
+    if (!cap) {
+        return nullptr;
+    }
+    reference(cap->m_color);
+    return (k4a_image_t)(void*)cap->m_color;
+}
+
+k4a_image_t k4a_capture_get_depth_image(k4a_capture_t capture_handle)
+{
+    Capture* cap = capture(capture_handle);
+    if (!cap) {
+        return nullptr;
+    }
+    reference(cap->m_depth);
+    return (k4a_image_t)(void*)cap->m_depth;
+}
+
+k4a_image_t k4a_capture_get_ir_image(k4a_capture_t capture_handle)
+{
+    Capture* cap = capture(capture_handle);
+    if (!cap) {
+        return nullptr;
+    }
+    reference(cap->m_ir);
+    return (k4a_image_t)(void*)cap->m_ir;
+}
+
+k4a_result_t k4a_image_create(k4a_image_format_t format, int width_pixels,
+    int height_pixels, int stride_bytes, k4a_image_t* image_handle)
+{
+    if (!image_handle || width_pixels <= 0 || height_pixels <= 0
+        || (stride_bytes <= 0 && stride(format, width_pixels) == 0)) {
+        return K4A_RESULT_FAILED;
+    }
+    *image_handle = (k4a_image_t)(void*)create(
+        format, width_pixels, height_pixels, stride_bytes);
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t k4a_image_create_from_buffer(k4a_image_format_t format,
+    int width_pixels, int height_pixels, int stride_bytes, uint8_t* buffer,
+    size_t buffer_size, k4a_memory_destroy_cb_t* buffer_release_cb,
+    void* buffer_release_cb_context, k4a_image_t* image_handle)
+{
+    if (!image_handle || !buffer) {
+        return K4A_RESULT_FAILED;
+    }
+    auto* img = new Image;
+    img->m_format = format;
+    img->m_width = width_pixels;
+    img->m_height = height_pixels;
+    img->m_stride = stride_bytes > 0 ? stride_bytes
+                                     : stride(format, width_pixels);
+    img->m_external = buffer;
+    img->m_externalSize = buffer_size;
+    img->m_release = buffer_release_cb;
+    img->m_releaseContext = buffer_release_cb_context;
+    *image_handle = (k4a_image_t)(void*)img;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+uint8_t* k4a_image_get_buffer(k4a_image_t image_handle)
+{
+    return image(image_handle) ? image(image_handle)->data() : nullptr;
+}
+
+size_t k4a_image_get_size(k4a_image_t image_handle)
+{
+    return image(image_handle) ? image(image_handle)->size() : 0;
+}
+
+k4a_image_format_t k4a_image_get_format(k4a_image_t image_handle)
+{
+    return image(image_handle) ? image(image_handle)->m_format
+                               : K4A_IMAGE_FORMAT_CUSTOM;
+}
+
+int k4a_image_get_width_pixels(k4a_image_t image_handle)
+{
+    return image(image_handle) ? image(image_handle)->m_width : 0;
+}
+
+int k4a_image_get_height_pixels(k4a_image_t image_handle)
+{
+    return image(image_handle) ? image(image_handle)->m_height : 0;
+}
+
+int k4a_image_get_stride_bytes(k4a_image_t image_handle)
+{
+    return image(image_handle) ? image(image_handle)->m_stride : 0;
+}
+
+uint64_t k4a_image_get_device_timestamp_usec(k4a_image_t image_handle)
+{
+    return image(image_handle) ? image(image_handle)->m_timestamp : 0;
+}
+
+void k4a_image_reference(k4a_image_t image_handle)
+{
+    reference(image(image_handle));
+}
+
+void k4a_image_release(k4a_image_t image_handle)
+{
+    release(image(image_handle));
+}
+
+k4a_transformation_t k4a_transformation_create(
+    const k4a_calibration_t* calibration)
+{
+    auto* transformation = new Transformation;
+    if (calibration) {
+        transformation->m_calibration = *calibration;
+    }
+    return (k4a_transformation_t)(void*)transformation;
+}
+
+void k4a_transformation_destroy(k4a_transformation_t transformation_handle)
+{
+    delete (Transformation*)(void*)transformation_handle;
+}
+
+k4a_result_t k4a_transformation_depth_image_to_color_camera(
+    k4a_transformation_t /* transformation_handle */,
+    const k4a_image_t depth_image,
+    k4a_image_t transformed_depth_image)
+{
+    Image* src = image(depth_image);
+    Image* dst = image(transformed_depth_image);
+    if (!src || !fits(dst, src->m_width, src->m_height, sizeof(uint16_t))) {
+        return K4A_RESULT_FAILED;
+    }
+    copyRows(src->data(), src->m_stride, dst->data(), dst->m_stride,
+        (size_t)src->m_width * sizeof(uint16_t), src->m_height);
+    dst->m_timestamp = src->m_timestamp;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t k4a_transformation_color_image_to_depth_camera(
+    k4a_transformation_t /* transformation_handle */,
+    const k4a_image_t depth_image,
+    const k4a_image_t color_image, k4a_image_t transformed_color_image)
+{
+    Image* depth = image(depth_image);
+    Image* src = image(color_image);
+    Image* dst = image(transformed_color_image);
+    if (!depth || !fits(src, depth->m_width, depth->m_height, 4)
+        || !fits(dst, depth->m_width, depth->m_height, 4)) {
+        return K4A_RESULT_FAILED;
+    }
+    copyRows(src->data(), src->m_stride, dst->data(), dst->m_stride,
+        (size_t)depth->m_width * 4, depth->m_height);
+    dst->m_timestamp = src->m_timestamp;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t k4a_transformation_depth_image_to_point_cloud(
+    k4a_transformation_t /* transformation_handle */,
+    const k4a_image_t depth_image,
+    const k4a_calibration_type_t /* camera */, k4a_image_t xyz_image)
+{
+    Image* depth = image(depth_image);
+    Image* dst = image(xyz_image);
+
+    // only captured depth images know their source: caller-created ones
+    // cannot be transformed
+    if (!depth || !depth->m_source) {
+        return K4A_RESULT_FAILED;
+    }
+    const int w = depth->m_width;
+    const int h = depth->m_height;
+    const size_t depthRow = (size_t)w * sizeof(uint16_t);
+    const size_t xyzRow = (size_t)w * 3 * sizeof(int16_t);
+    if (!fits(depth, w, h, sizeof(uint16_t))
+        || !fits(dst, w, h, 3 * sizeof(int16_t))) {
+        return K4A_RESULT_FAILED;
+    }
+
+    // sources read and write packed rows: repack padded images
+    std::vector<uint8_t> packedDepth;
+    std::vector<uint8_t> packedXyz;
+    const uint8_t* in = depth->data();
+    uint8_t* out = dst->data();
+    if ((size_t)depth->m_stride != depthRow) {
+        packedDepth.resize(depthRow * h);
+        copyRows(in, depth->m_stride, packedDepth.data(), depthRow, depthRow,
+            h);
+        in = packedDepth.data();
+    }
+    if ((size_t)dst->m_stride != xyzRow) {
+        packedXyz.resize(xyzRow * h);
+        out = packedXyz.data();
+    }
+    depth->m_source->xyz(depth->m_frame, (const uint16_t*)(const void*)in,
+        (int16_t*)(void*)out);
+    if (!packedXyz.empty()) {
+        copyRows(out, xyzRow, dst->data(), dst->m_stride, xyzRow, h);
+    }
+    dst->m_timestamp = depth->m_timestamp;
+    return K4A_RESULT_SUCCEEDED;
+}
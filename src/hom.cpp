@@ -2,22 +2,29 @@
 #include <opencv2/core.hpp>
 #include <opencv2/opencv.hpp>
 
+#include "composite.h"
+#include "geometry.h"
+#include "pool.h"
+
 cv::Mat background;                     // background image
 cv::Mat foreground;                     // foreground image
+MatPool pool;                           // overlay workspace
 // std::vector<cv::Point2f> backgroundRoi; // background region (4 corners)
 // std::vector<cv::Point2f> foregroundRoi; // projection region (4 corners)
 
-void overlay(cv::Mat& src, cv::Mat& dst)
+// the caller owns workspace and resets it once per frame
+void overlay(
+    cv::Mat& src, cv::Mat& dst, const cv::Rect& box, MatPool& workspace)
 {
-    cv::Mat gray, grayCopy, grayInv, grayInvCopy;
-    cv::cvtColor(dst, gray, cv::COLOR_BGR2GRAY);
-    cv::threshold(gray, gray, 0, 255, cv::THRESH_BINARY);
-    cv::bitwise_not(gray, grayInv);
+    cv::Mat homography = workspace.acquire(src.size(), src.type());
+    src.copyTo(homography);
 
-    dst.copyTo(grayCopy, gray);
-    src.copyTo(grayInvCopy, grayInv);
+    // warped foreground patch (dst) wins wherever it is non-zero
+    if (!box.empty()) {
+        cv::Mat roi = homography(box);
+        composite::over(dst, roi, roi);
+    }
 
-    cv::Mat homography = grayInvCopy + grayCopy;
     cv::imshow("homography", homography);
     cv::waitKey(0);
 }
@@ -38,8 +45,10 @@ int main()
 
     std::cout << "-- computing homography " << std::endl;
     cv::Mat homography = cv::findHomography(backgroundRoi, foregroundRoi, 0);
-    cv::warpPerspective(foreground, warpedForeground, homography, background.size());
-    overlay(background, warpedForeground);
+    cv::Rect box = geometry::warp(
+        foreground, homography, background.size(), warpedForeground);
+    pool.reset();
+    overlay(background, warpedForeground, box, pool);
 
     // while (true) {
     //     int key = cv::waitKey(10);
@@ -4,6 +4,8 @@
 #include <opencv2/opencv.hpp>
 #include <string>
 
+#include "contrast.h"
+
 namespace icon {
 
     cv::Mat load(const std::string& path){
@@ -22,16 +24,7 @@ namespace icon {
     }
 
     void saturate(cv::Mat& inputImg, const int& beta, const double& alpha){
-        cv::Mat outputImg = cv::Mat::zeros(inputImg.size(), inputImg.type());
-        for (int y = 0; y < inputImg.rows; y++) {
-            for (int x = 0; x < inputImg.cols; x++) {
-                for (int c = 0; c < inputImg.channels(); c++) {
-                    outputImg.at<cv::Vec3b>(y, x)[c] = cv::saturate_cast<uchar>(
-                            alpha * inputImg.at<cv::Vec3b>(y, x)[c] + beta);
-                }
-            }
-        }
-        inputImg = outputImg;
+        contrast::apply(inputImg, inputImg, alpha, beta);
     }
 
     void scale(cv::Mat& img, const int& w, const int& h)
@@ -0,0 +1,134 @@
+/* point cloud build:
+ *   pcloud::build's row-parallel compaction against the serial loop it
+ *   replaced (kept verbatim below), on synthetic depth and point-cloud
+ *   buffers whose heights do and do not split evenly into row blocks
+ */
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "pcloud.h"
+
+static int failures = 0;
+
+#define CHECK(condition)                                                       \
+    if (!(condition)) {                                                        \
+        std::cerr << __FILE__ << ":" << __LINE__ << ": " << #condition        \
+                  << std::endl;                                                \
+        failures++;                                                            \
+    }
+
+// the original pcloud::build
+static std::vector<Point> baseline(
+    const int& w, const int& h, const int16_t* pCloudData, const uint8_t* bgra)
+{
+    std::vector<Point> pCloud;
+    for (int i = 0; i < w * h; i++) {
+        Point point {};
+        point.m_xyz[0] = pCloudData[3 * i + 0];
+        point.m_xyz[1] = pCloudData[3 * i + 1];
+        point.m_xyz[2] = pCloudData[3 * i + 2];
+        if (point.m_xyz[2] == 0) {
+            continue;
+        }
+        uint8_t r = bgra[4 * i + 2];
+        uint8_t g = bgra[4 * i + 1];
+        uint8_t b = bgra[4 * i + 0];
+        uint8_t a = bgra[4 * i + 3];
+        uint8_t rgba[4] = { r, g, b, a };
+        point.setRGBA(rgba);
+
+        if (point.m_rgba[0] == 0 && point.m_rgba[1] == 0 && point.m_rgba[2] == 0
+            && point.m_rgba[3] == 0) {
+            continue;
+        }
+        pCloud.push_back(point);
+    }
+    return pCloud;
+}
+
+// a depth image and the point cloud a pinhole camera makes of it, with
+// holes, black pixels, and pixels black in every channel but one
+static void synthetic(const int& w, const int& h, std::vector<int16_t>& xyz,
+    std::vector<uint8_t>& bgra)
+{
+    xyz.resize((size_t)3 * w * h);
+    bgra.resize((size_t)4 * w * h);
+    uint32_t state = 2024;
+    for (int r = 0; r < h; r++) {
+        for (int c = 0; c < w; c++) {
+            const int i = r * w + c;
+            state = state * 1664525u + 1013904223u;
+            auto depth = (int16_t)(500 + (state >> 20));
+            if (state % 5 == 0) {
+                depth = 0;
+            }
+            xyz[3 * i + 0] = (int16_t)((c - w / 2) * depth / 500);
+            xyz[3 * i + 1] = (int16_t)((r - h / 2) * depth / 500);
+            xyz[3 * i + 2] = depth;
+
+            uint8_t* px = &bgra[4 * i];
+            for (int k = 0; k < 4; k++) {
+                px[k] = (uint8_t)(state >> (6 * k + 2));
+            }
+            if (state % 3 == 0) {
+                px[0] = px[1] = px[2] = px[3] = 0;
+            } else if (state % 3 == 1) {
+                px[0] = px[1] = px[2] = 0; // only alpha
+            }
+        }
+    }
+}
+
+static bool same(const std::vector<Point>& a, const std::vector<Point>& b)
+{
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        for (int k = 0; k < 4; k++) {
+            if (a[i].m_rgba[k] != b[i].m_rgba[k]
+                || (k < 3 && a[i].m_xyz[k] != b[i].m_xyz[k])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main()
+{
+    // one row, fewer rows than a block, k4a depth modes, and an odd
+    // height that leaves a short last block
+    const int sizes[][2]
+        = { { 7, 1 }, { 33, 31 }, { 320, 288 }, { 640, 576 }, { 101, 257 } };
+    std::vector<int16_t> xyz;
+    std::vector<uint8_t> bgra;
+    for (const auto& size : sizes) {
+        const int w = size[0];
+        const int h = size[1];
+        synthetic(w, h, xyz, bgra);
+        std::vector<Point> expected = baseline(w, h, xyz.data(), bgra.data());
+        CHECK(!expected.empty());
+
+        CHECK(same(pcloud::build(w, h, xyz.data(), bgra.data()), expected));
+        CHECK(pcloud::count(w, h, xyz.data(), bgra.data()) == expected.size());
+
+        // a reused cloud, larger than this frame needs
+        std::vector<Point> reused(expected.size() + 100);
+        pcloud::build(w, h, xyz.data(), bgra.data(), reused);
+        CHECK(same(reused, expected));
+    }
+
+    // nothing valid: no points
+    synthetic(640, 576, xyz, bgra);
+    std::fill(xyz.begin(), xyz.end(), 0);
+    std::vector<Point> empty = pcloud::build(640, 576, xyz.data(), bgra.data());
+    CHECK(empty.empty());
+
+    if (failures != 0) {
+        std::cerr << "-- " << failures << " checks failed" << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,119 @@
+/* convolution methods:
+ *   FFT (overlap-add over cached kernel spectra) and BOX_CASCADE against
+ *   SEPARABLE on synthetic 8-bit images of odd and even sizes, with tile
+ *   sizes of 128 and 256; FFT and SEPARABLE differ only by rounding,
+ *   BOX_CASCADE only approximates the gaussian
+ */
+#include <iostream>
+#include <opencv2/imgproc.hpp>
+
+#include "convolve.h"
+
+static int failures = 0;
+
+#define CHECK(condition)                                                       \
+    if (!(condition)) {                                                        \
+        std::cerr << __FILE__ << ":" << __LINE__ << ": " << #condition        \
+                  << std::endl;                                                \
+        failures++;                                                            \
+    }
+
+// uniform noise with a saturated rectangle: edges the kernels must carry
+// to the right place
+static cv::Mat synthetic(const cv::Size& size)
+{
+    cv::Mat src(size, CV_8UC1);
+    cv::RNG rng(2024);
+    rng.fill(src, cv::RNG::UNIFORM, 0, 256);
+    src(cv::Rect(size.width / 3, size.height / 4, size.width / 6,
+            size.height / 4))
+        .setTo(255);
+    return src;
+}
+
+static double maxDiff(const cv::Mat& a, const cv::Mat& b)
+{
+    cv::Mat diff;
+    cv::absdiff(a, b, diff);
+    double max = 0;
+    cv::minMaxLoc(diff, nullptr, &max);
+    return max;
+}
+
+// FFT against SEPARABLE, within rounding
+static bool sameAsSeparable(Convolver& convolver, const cv::Mat& src,
+    cv::Mat& fft)
+{
+    cv::Mat separable;
+    convolver.apply(src, separable, SEPARABLE);
+    convolver.apply(src, fft, FFT);
+    return fft.size() == src.size() && fft.type() == src.type()
+        && maxDiff(fft, separable) <= 2;
+}
+
+int main()
+{
+    // odd and even sizes; a 31x31 kernel tiles them in 128 and 256
+    const cv::Size sizes[] = { cv::Size(200, 150), cv::Size(201, 151),
+        cv::Size(640, 480), cv::Size(641, 479) };
+
+    // an asymmetric kernel catches a missing flip, a non-square one
+    // swapped axes
+    cv::Mat ramp(9, 1, CV_32F);
+    for (int i = 0; i < ramp.rows; i++) {
+        ramp.at<float>(i) = (float)(i + 1) / 45.0f;
+    }
+    Convolver convolvers[] = { Convolver(cv::Size(31, 31), 0),
+        Convolver(cv::Size(9, 21), 0),
+        Convolver(ramp, cv::getGaussianKernel(21, 0, CV_32F)) };
+
+    // one convolver per kernel across the sizes: its spectrum cache
+    // then holds both tile sizes
+    for (Convolver& convolver : convolvers) {
+        cv::Mat first;
+        for (const cv::Size& size : sizes) {
+            cv::Mat src = synthetic(size);
+            cv::Mat fft;
+            CHECK(sameAsSeparable(convolver, src, fft));
+            if (first.empty()) {
+                first = fft;
+            }
+        }
+
+        // back to the first size: a cached spectrum, the same result
+        cv::Mat again;
+        convolver.apply(synthetic(sizes[0]), again, FFT);
+        CHECK(maxDiff(again, first) == 0);
+    }
+
+    // a kernel larger than the image
+    Convolver large(cv::Size(75, 75), 0);
+    cv::Mat fft;
+    CHECK(sameAsSeparable(large, synthetic(cv::Size(65, 47)), fft));
+
+    // box cascade: close to the gaussian, pixel by pixel and on average
+    const double sigmas[] = { 2, 6 };
+    for (const double& sigma : sigmas) {
+        Convolver gaussian(cv::Size(), sigma, true);
+        for (const cv::Size& size : sizes) {
+            cv::Mat src = synthetic(size);
+            cv::Mat separable, box;
+            gaussian.apply(src, separable, SEPARABLE);
+            gaussian.apply(src, box, BOX_CASCADE);
+            CHECK(box.size() == src.size() && box.type() == src.type());
+            CHECK(maxDiff(box, separable) <= 8);
+
+            cv::Mat diff;
+            cv::absdiff(box, separable, diff);
+            CHECK(cv::mean(diff)[0] <= 1.0);
+        }
+    }
+
+    // the segmentation blur in example-15 stays separable on color frames
+    CHECK(large.choose(cv::Size(1280, 720)) == SEPARABLE);
+
+    if (failures != 0) {
+        std::cerr << "-- " << failures << " checks failed" << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
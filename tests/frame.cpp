@@ -0,0 +1,108 @@
+/* Frame lifetime:
+ *   runs against the k4a replay library, whose captures are synthetic
+ *   frames that differ from one capture to the next; a view that outlives
+ *   its image would then read a later frame's (or freed) memory
+ */
+#include <cstring>
+#include <iostream>
+#include <k4a/k4a.h>
+#include <vector>
+
+#include "frame.h"
+
+static int failures = 0;
+
+#define CHECK(condition)                                                       \
+    if (!(condition)) {                                                        \
+        std::cerr << __FILE__ << ":" << __LINE__ << ": " << #condition        \
+                  << std::endl;                                                \
+        failures++;                                                            \
+    }
+
+// the color image of a new capture; the caller owns the returned reference
+static k4a_image_t colorImage(k4a_device_t device)
+{
+    k4a_capture_t capture = nullptr;
+    if (k4a_device_get_capture(device, &capture, 1000)
+        != K4A_WAIT_RESULT_SUCCEEDED) {
+        return nullptr;
+    }
+    k4a_image_t image = k4a_capture_get_color_image(capture);
+    k4a_capture_release(capture);
+    return image;
+}
+
+// churn the allocator with later captures, which carry other pixels
+static void churn(k4a_device_t device)
+{
+    for (int i = 0; i < 4; i++) {
+        k4a_image_release(colorImage(device));
+    }
+}
+
+static bool same(const Frame& frame, const std::vector<uint8_t>& expected)
+{
+    const cv::Mat& mat = frame.mat();
+    if (mat.empty() || !mat.isContinuous()
+        || mat.total() * mat.elemSize() != expected.size()) {
+        return false;
+    }
+    return std::memcmp(mat.data, expected.data(), expected.size()) == 0;
+}
+
+int main()
+{
+    k4a_device_t device = nullptr;
+    k4a_device_configuration_t config = K4A_DEVICE_CONFIG_INIT_DISABLE_ALL;
+    config.color_format = K4A_IMAGE_FORMAT_COLOR_BGRA32;
+    if (k4a_device_open(0, &device) != K4A_RESULT_SUCCEEDED
+        || k4a_device_start_cameras(device, &config) != K4A_RESULT_SUCCEEDED) {
+        std::cerr << "-- failed to open the k4a replay device" << std::endl;
+        return 1;
+    }
+
+    // a frame keeps its image alive after the capture and the caller
+    // release theirs
+    k4a_image_t image = colorImage(device);
+    CHECK(image != nullptr);
+    const uint8_t* buffer = k4a_image_get_buffer(image);
+    std::vector<uint8_t> expected(buffer, buffer + k4a_image_get_size(image));
+    uint64_t timestamp = k4a_image_get_device_timestamp_usec(image);
+
+    Frame frame(image, CV_8UC4);
+    k4a_image_release(image);
+    churn(device);
+    CHECK(same(frame, expected));
+    CHECK(frame.timestamp() == timestamp);
+
+    // copies share the reference: the last one alive keeps the image
+    {
+        Frame copy = frame;
+        frame = Frame();
+        churn(device);
+        CHECK(frame.empty());
+        CHECK(same(copy, expected));
+        frame = copy;
+    }
+    churn(device);
+    CHECK(same(frame, expected));
+
+    // a clone is independent of the image
+    cv::Mat clone = frame.mat().clone();
+    frame = Frame();
+    churn(device);
+    CHECK(std::memcmp(clone.data, expected.data(), expected.size()) == 0);
+
+    // no image, no view
+    Frame none(nullptr, CV_8UC4);
+    CHECK(none.empty());
+    CHECK(none.timestamp() == 0);
+
+    k4a_device_stop_cameras(device);
+    k4a_device_close(device);
+
+    if (failures != 0) {
+        std::cerr << "-- " << failures << " checks failed" << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,153 @@
+/* ply round trip:
+ *   writes a synthetic organized cloud in both ply encodings, through
+ *   both pcloud::write overloads, and parses the files back; every vertex
+ *   must match the cloud pcloud::build compacts from the same buffers
+ */
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "pcloud.h"
+
+static int failures = 0;
+
+#define CHECK(condition)                                                       \
+    if (!(condition)) {                                                        \
+        std::cerr << __FILE__ << ":" << __LINE__ << ": " << #condition        \
+                  << std::endl;                                                \
+        failures++;                                                            \
+    }
+
+// deterministic xyz + bgra buffers: holes, black pixels, and the int16
+// extremes the ascii records must hold
+static void synthetic(const int& w, const int& h, std::vector<int16_t>& xyz,
+    std::vector<uint8_t>& bgra)
+{
+    xyz.resize((size_t)3 * w * h);
+    bgra.resize((size_t)4 * w * h);
+    uint32_t state = 12345;
+    for (int i = 0; i < w * h; i++) {
+        state = state * 1664525u + 1013904223u;
+        for (int k = 0; k < 3; k++) {
+            xyz[3 * i + k] = (int16_t)(state >> (8 * k));
+        }
+        for (int k = 0; k < 4; k++) {
+            bgra[4 * i + k] = (uint8_t)(state >> (5 * k + 3));
+        }
+        switch (i % 7) {
+        case 0: // no depth
+            xyz[3 * i + 2] = 0;
+            break;
+        case 1: // no color
+            std::fill(&bgra[4 * i], &bgra[4 * i + 4], 0);
+            break;
+        case 2:
+            xyz[3 * i + 0] = INT16_MIN;
+            xyz[3 * i + 1] = INT16_MAX;
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+// vertices of a ply file written by pcloud::write, as x y z r g b rows
+static std::vector<std::array<int, 6>> readPly(const std::string& file)
+{
+    std::ifstream ifs(file, std::ios::binary);
+    std::string line;
+    size_t size = 0;
+    bool binary = false;
+    while (std::getline(ifs, line) && line != "end_header") {
+        if (line.rfind("element vertex ", 0) == 0) {
+            size = std::stoul(line.substr(15));
+        }
+        binary = binary || line == "format binary_little_endian 1.0";
+    }
+
+    std::vector<std::array<int, 6>> vertices(size);
+    for (auto& v : vertices) {
+        if (!binary) {
+            ifs >> v[0] >> v[1] >> v[2] >> v[3] >> v[4] >> v[5];
+            continue;
+        }
+        unsigned char record[9];
+        ifs.read((char*)record, sizeof(record));
+        for (int i = 0; i < 3; i++) {
+            v[i] = (int16_t)(record[2 * i] | record[2 * i + 1] << 8);
+            v[3 + i] = record[6 + i];
+        }
+    }
+
+    // nothing may follow the last vertex
+    if (ifs) {
+        ifs >> std::ws;
+        ifs.peek();
+    }
+    return ifs.eof() ? vertices : std::vector<std::array<int, 6>>();
+}
+
+// k4a color is bgr: the file holds (m_rgba[2], [1], [0])
+static bool same(const std::vector<std::array<int, 6>>& vertices,
+    const std::vector<Point>& pCloud)
+{
+    if (vertices.size() != pCloud.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < vertices.size(); i++) {
+        const Point& p = pCloud[i];
+        const std::array<int, 6> expected = { (int16_t)p.m_xyz[0],
+            (int16_t)p.m_xyz[1], (int16_t)p.m_xyz[2], p.m_rgba[2], p.m_rgba[1],
+            p.m_rgba[0] };
+        if (vertices[i] != expected) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main()
+{
+    const int w = 64;
+    const int h = 48;
+    std::vector<int16_t> xyz;
+    std::vector<uint8_t> bgra;
+    synthetic(w, h, xyz, bgra);
+    std::vector<Point> pCloud = pcloud::build(w, h, xyz.data(), bgra.data());
+    CHECK(!pCloud.empty());
+    CHECK(pCloud.size() == pcloud::count(w, h, xyz.data(), bgra.data()));
+
+    const pcloud::Format formats[] = { pcloud::ASCII, pcloud::BINARY };
+    for (const pcloud::Format& format : formats) {
+        const std::string name
+            = format == pcloud::ASCII ? "ply-ascii" : "ply-binary";
+
+        // straight from the buffers
+        const std::string buffers = name + "-buffers.ply";
+        pcloud::write(w, h, xyz.data(), bgra.data(), buffers, format);
+        CHECK(same(readPly(buffers), pCloud));
+        std::remove(buffers.c_str());
+
+        // from the compacted cloud
+        const std::string cloud = name + "-cloud.ply";
+        pcloud::write(pCloud, cloud, format);
+        CHECK(same(readPly(cloud), pCloud));
+        std::remove(cloud.c_str());
+    }
+
+    // an empty cloud is a header only
+    std::vector<Point> none;
+    pcloud::write(none, "ply-empty.ply", pcloud::BINARY);
+    CHECK(readPly("ply-empty.ply").empty());
+    std::remove("ply-empty.ply");
+
+    if (failures != 0) {
+        std::cerr << "-- " << failures << " checks failed" << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}